@@ -0,0 +1,246 @@
+# frozen_string_literal: true
+require File.expand_path("../../lib/stupidedi", __FILE__)
+require "ruby/blank"
+require "json"
+require "stringio"
+require "time"
+
+using Stupidedi::Refinements
+
+#
+# Measures the throughput of the reader, parser, writers, and validators on
+# the `spec/fixtures` files and on synthetic files of the given sizes, and
+# prints the results as JSON. This is usually run with `rake bench`:
+#
+#   $ rake bench                           # fixtures and a 1 MB file
+#   $ rake bench SIZES=1,10,100            # ... and 10 MB and 100 MB files
+#   $ rake bench ONLY=reader,parser        # only run some of the benchmarks
+#   $ rake bench OUTPUT=bench_output.json  # write results to a file
+#
+# Each benchmark runs in a forked process, when possible, which builds its
+# own input, so the peak RSS that's reported doesn't include the other
+# inputs or benchmarks. A forked process starts with the memory of this
+# one, so the growth of the peak RSS after the input was built is reported
+# too. It includes the benchmark's setup, like parsing the input for the
+# writers.
+#
+module Bench
+  ROOT = File.expand_path("../..", __FILE__)
+
+  # The synthetic inputs repeat the interchange in this file
+  SYNTHETIC = "spec/fixtures/005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi"
+
+  SEPARATORS = Stupidedi::Reader::Separators.build \
+    :segment    => "~\n",
+    :element    => "*",
+    :component  => ":",
+    :repetition => "^"
+
+  class << self
+    # @return [Stupidedi::Config]
+    def config
+      @config ||= Stupidedi::Config.contrib(Stupidedi::Config.hipaa(Stupidedi::Config.default)).tap do |config|
+        config.editor.tap do |c|
+          c.register(Stupidedi::Interchanges::FourOhOne::InterchangeDef) { Stupidedi::Editor::FiveOhOneEd }
+          c.register(Stupidedi::Interchanges::FiveOhOne::InterchangeDef) { Stupidedi::Editor::FiveOhOneEd }
+          c.register(Stupidedi::Versions::FortyTen::FunctionalGroupDef) { Stupidedi::Editor::FiftyTenEd }
+          c.register(Stupidedi::Versions::FiftyTen::FunctionalGroupDef) { Stupidedi::Editor::FiftyTenEd }
+          c.register(Stupidedi::TransactionSets::FiftyTen::Implementations::X222A1::HC837) { Stupidedi::Editor::X222 }
+        end
+      end
+    end
+
+    # Each benchmark takes a list of inputs and, optionally, the result of
+    # its setup block, which isn't measured
+    #
+    # @return [Hash<String, [Proc, Proc]>]
+    def benchmarks
+      { "reader"         => [nil, lambda{|inputs, _| inputs.each{|x| tokenize(x) } }],
+        "parser"         => [nil, lambda{|inputs, _| parse(inputs) }],
+        "writer_default" => [method(:parse), lambda{|_, m| Stupidedi::Writer::Default.new(m.zipper.fetch.root, SEPARATORS).write(StringIO.new) }],
+        "writer_json"    => [method(:parse), lambda{|_, m| Stupidedi::Writer::Json.new(StringIO.new).write(m.zipper.fetch.root).flush }],
+        "writer_claredi" => [method(:parse), lambda{|_, m| Stupidedi::Writer::Claredi.new(m.zipper.fetch.root.node).write(StringIO.new) }],
+        "editor"         => [method(:parse), lambda{|_, m| Stupidedi::Editor::TransmissionEd.new(config, Time.now).critique(m) }] }
+    end
+
+    # Each input is built when its Proc is called, so the synthetic inputs
+    # are only built in the process that measures them
+    #
+    # @return [Hash<String, Proc>]
+    def inputs(sizes)
+      fixtures = fixtures().values
+
+      sizes.inject("fixtures" => lambda { fixtures }) do |inputs, size|
+        inputs.update("synthetic_#{size}mb" => lambda { [synthetic(size * 1024 * 1024)] })
+      end
+    end
+
+    # The passing fixtures, except those that one of the benchmarks can't
+    # process without raising an exception
+    #
+    # @return [Hash<String, String>]
+    def fixtures
+      @fixtures ||= begin
+        paths = Dir["#{ROOT}/spec/fixtures/*/*/{pass,case}/**/*.edi"].sort
+        paths.inject({}) do |fixtures, path|
+          input = File.open(path, "rb", &:read)
+
+          begin
+            benchmarks.each_value{|setup, run| run.call([input], setup.try(:call, [input])) }
+            fixtures.update(path[ROOT.length + 1..-1] => input)
+          rescue StandardError
+            skipped << path[ROOT.length + 1..-1]
+            fixtures
+          end
+        end
+      end
+    end
+
+    # @return [Array<String>]
+    def skipped
+      @skipped ||= []
+    end
+
+    # Repeats the interchange from {SYNTHETIC}, with a new control number
+    # each time, until the result has at least `bytes` bytes
+    #
+    # @return [String]
+    def synthetic(bytes)
+      interchange, = File.open(File.join(ROOT, SYNTHETIC), "rb", &:read).scan(/^ISA.*?^IEA.*?~/m)
+
+      count = (bytes + interchange.bytesize - 1) / interchange.bytesize
+      count.times.map{|n| interchange.gsub("000000905", "%09d" % (n + 1)) }.join("\n")
+    end
+
+    # @return [Integer]
+    def tokenize(input)
+      reader = Stupidedi::Reader.build(input)
+      count  = 0
+
+      while (result = reader.read_segment).defined?
+        reader = result.remainder
+        count += 1
+      end
+
+      count
+    end
+
+    # @return [Stupidedi::Parser::StateMachine]
+    def parse(inputs, _ = nil)
+      inputs.inject(Stupidedi::Parser.build(config)) do |machine, input|
+        machine, = machine.read(Stupidedi::Reader.build(input))
+        machine
+      end
+    end
+
+    # @return [Hash]
+    def measure(name, label, build)
+      inputs = build.call
+
+      GC.start
+      baseline   = peak_rss
+      setup, run = benchmarks.fetch(name)
+      prepared   = setup.try(:call, inputs)
+
+      GC.start
+      GC::Profiler.enable unless GC.stat.key?(:time)
+
+      before  = GC.stat
+      started = Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      run.call(inputs, prepared)
+      elapsed = Process.clock_gettime(Process::CLOCK_MONOTONIC) - started
+      after   = GC.stat
+
+      peak      = peak_rss
+      segments  = inputs.sum{|x| tokenize(x) }
+      allocated = after[:total_allocated_objects] - before[:total_allocated_objects]
+      gc_time   =
+        if after.key?(:time)
+          after[:time] - before[:time]
+        else
+          (GC::Profiler.total_time * 1000).round.tap { GC::Profiler.disable }
+        end
+
+      { "benchmark"                     => name,
+        "input"                         => label,
+        "bytes"                         => inputs.sum(&:bytesize),
+        "segments"                      => segments,
+        "seconds"                       => elapsed.round(6),
+        "segments_per_second"           => (segments / elapsed).round(1),
+        "allocated_objects"             => allocated,
+        "allocated_objects_per_segment" => (allocated.to_f / segments).round(1),
+        "gc_count"                      => after[:count] - before[:count],
+        "gc_time_ms"                    => gc_time,
+        "peak_rss_kb"                   => peak,
+        "peak_rss_growth_kb"            => (peak - baseline unless peak.nil? or baseline.nil?) }
+    end
+
+    # Runs `measure` in a child process when `fork` is supported
+    #
+    # @return [Hash]
+    def isolate(*args)
+      return measure(*args) unless Process.respond_to?(:fork)
+
+      reader, writer = IO.pipe
+      pid = fork do
+        reader.close
+        writer.write(JSON.generate(measure(*args)))
+        writer.close
+        exit!(0)
+      end
+
+      writer.close
+      result = reader.read
+      reader.close
+      Process.wait(pid)
+
+      raise "benchmark #{args.first} failed in process #{pid}" if result.empty?
+      JSON.parse(result)
+    end
+
+    # High-water mark of the resident set size in kilobytes, when it's
+    # reported by the operating system
+    #
+    # @return [Integer, nil]
+    def peak_rss
+      if File.readable?("/proc/self/status")
+        File.read("/proc/self/status")[/^VmHWM:\s*(\d+)/, 1].try(:to_i)
+      else
+        rss = `ps -o rss= -p #{Process.pid}`.strip
+        rss.to_i unless rss.empty?
+      end
+    end
+
+    # @return [Hash]
+    def run(sizes, only)
+      names   = only.empty? ? benchmarks.keys : only
+      unknown = names - benchmarks.keys
+
+      unless unknown.empty?
+        raise ArgumentError, "unknown benchmarks: #{unknown.join(", ")}"
+      end
+
+      results = inputs(sizes).flat_map do |label, build|
+        names.map{|name| isolate(name, label, build) }
+      end
+
+      { "ruby"      => RUBY_DESCRIPTION,
+        "stupidedi" => Stupidedi::VERSION,
+        "time"      => Time.now.utc.iso8601,
+        "skipped"   => skipped,
+        "results"   => results }
+    end
+  end
+end
+
+if $0 == __FILE__
+  sizes  = ENV.fetch("SIZES", "1").split(",").map{|x| Integer(x) }
+  only   = ENV.fetch("ONLY", "").split(",")
+  report = JSON.pretty_generate(Bench.run(sizes, only))
+
+  if ENV["OUTPUT"].present?
+    File.write(ENV["OUTPUT"], report + "\n")
+  else
+    $stdout.puts report
+  end
+end
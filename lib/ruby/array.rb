@@ -43,8 +43,7 @@ module Stupidedi
       #
       # @return [Array]
       def tail
-        _, *xs = self
-        xs
+        drop(1)
       end
 
       # Selects all elements except the last `n` ones.
@@ -49,9 +49,128 @@ module Stupidedi
   autoload :Versions,         "stupidedi/versions"
   autoload :VERSION,          "stupidedi/version"
 
-  def self.caller(depth = 2)
-    if k = ::Kernel.caller.at(depth - 1)
-      k.split(":")
+  # Loads every interchange, functional group, and transaction set definition
+  # registered in `config`, and the code lists registered in
+  # {Config#code_list}, so they aren't loaded while the first input is parsed.
+  # When GS08 versions are given, only those transaction sets are loaded,
+  # like {Parser.precompile}, which also computes their parser instructions.
+  #
+  # The definitions are frozen with {Schema.deep_freeze}, and the heap is
+  # compacted where `GC.compact` is supported, so when this is called before
+  # an application forks its workers, the workers share one copy of the
+  # definitions instead of each touching (and copying) their pages.
+  #
+  # @example
+  #   Stupidedi.preload(Stupidedi::Config.hipaa, "005010X222A1")
+  #
+  # @return [Config]
+  def self.preload(config, *versions)
+    Parser.precompile(config, *versions)
+    definitions(config, versions).each{|d| Schema.deep_freeze(d) }
+
+    GC.start
+    GC.compact if GC.respond_to?(:compact)
+    config
+  end
+
+  # Like {preload}, then returns a frozen copy of `config` that can be
+  # passed to any number of Ractors, which each parse their own input. The
+  # copy refers to the loaded definitions instead of the blocks that
+  # construct them, and it and the definitions are made shareable with
+  # `Ractor.make_shareable`. Only the transaction sets of the given GS08
+  # versions are copied, because other Ractors can't load definitions. For
+  # the same reason, the parser, reader, and value classes are loaded here
+  # instead of when they're first used.
+  #
+  # Each Ractor other than the main one computes its own parser instructions
+  # the first time it parses, because {Parser::Cache} can't be shared.
+  #
+  # @example
+  #   config  = Stupidedi.make_shareable(Stupidedi::Config.hipaa, "005010X221A1")
+  #   ractors = paths.map do |path|
+  #     Ractor.new(config, path) do |c, p|
+  #       machine, result = Stupidedi::Parser.build(c).read(Stupidedi::Reader.build(File.binread(p)))
+  #       ...
+  #     end
+  #   end
+  #
+  # @return [Config]
+  def self.make_shareable(config, *versions)
+    preload(config, *versions)
+
+    copy = Config.new.customize do |c|
+      config.interchange.table.each_key{|k| c.interchange.register(k, config.interchange.at(k)) }
+      config.functional_group.table.each_key{|k| c.functional_group.register(k, config.functional_group.at(k)) }
+      config.code_list.table.each_key{|k| c.code_list.register(k, config.code_list.at(k)) }
+      config.editor.table.each_key{|k| c.editor.register(k, config.editor.at(k)) }
+
+      config.transaction_set.table.each_key do |key|
+        next unless versions.empty? or versions.include?(key.first)
+        c.transaction_set.register(*key, config.transaction_set.at(*key))
+      end
+
+      c.lazy_elements = config.lazy_elements
+      c.projection    = config.projection.ids if config.projection
+    end
+
+    return copy.freeze unless defined?(Ractor)
+
+    eager_load(Either, Exceptions, Parser, Reader, Schema, Sets, Values, Zipper)
+
+    definitions(copy, versions).each do |d|
+      Ractor.make_shareable(d)
+
+      # The tokenizer looks up segment definitions by their constant name
+      next unless d.respond_to?(:segment_dict)
+
+      dict = d.segment_dict
+      if dict.is_a?(Module)
+        dict.constants.each{|c| Ractor.make_shareable(dict.const_get(c)) }
+      else
+        Ractor.make_shareable(dict)
+      end
+    end
+
+    Ractor.make_shareable(copy)
+  end
+
+  # Loads the autoloaded constants of each module, and of the modules and
+  # classes nested in it
+  def self.eager_load(*modules)
+    modules.each do |m|
+      m.constants(false).each do |name|
+        value = m.const_get(name, false)
+
+        # Skip constants that refer to modules defined elsewhere
+        next unless value.is_a?(Module) and value.name == "#{m.name}::#{name}"
+        eager_load(value)
+      end
+    end
+  end
+  private_class_method :eager_load
+
+  # @return [Array<Schema::AbstractDef, Schema::CodeList>]
+  def self.definitions(config, versions)
+    definitions =
+      config.interchange.table.keys.map{|k| config.interchange.at(k) } +
+      config.functional_group.table.keys.map{|k| config.functional_group.at(k) }
+
+    config.transaction_set.table.each_key do |key|
+      next unless versions.empty? or versions.include?(key.first)
+      definitions << config.transaction_set.at(*key)
+    end
+
+    config.code_list.table.each_key do |id|
+      definitions << config.code_list.at(id)
     end
+
+    definitions
+  end
+  private_class_method :definitions
+
+  def self.caller(depth = 2)
+    # Only the one frame is needed, so don't build the whole backtrace
+    k, = ::Kernel.caller(depth, 1)
+    k.split(":") if k
   end
 end
@@ -26,12 +26,43 @@ module Stupidedi
     # @return [EditorConfig]
     attr_reader :editor
 
+    # When true, the parser keeps the text of each simple element and only
+    # converts it to a typed value when it's first used. See
+    # {Values::LazyElementVal}
+    #
+    # @return [Boolean]
+    attr_accessor :lazy_elements
+
+    # When set, the parser only builds values for the segments in these
+    # tables, loops, and segments of each transaction set, and stores the
+    # others as a {Values::RawSegmentVal}. See {Parser::Projection}
+    #
+    # @example
+    #   config.projection = %w(2100 2110)
+    #
+    # @return [Parser::Projection]
+    attr_reader :projection
+
+    # When set, the parser counts the time and number of segments in each
+    # phase of parsing. See {Parser::Instrumentation}
+    #
+    # @return [Parser::Instrumentation]
+    attr_accessor :instrumentation
+
     def initialize
       @interchange      = InterchangeConfig.new
       @functional_group = FunctionalGroupConfig.new
       @transaction_set  = TransactionSetConfig.new
       @code_list        = CodeListConfig.new
       @editor           = EditorConfig.new
+      @lazy_elements    = false
+      @projection       = nil
+      @instrumentation  = nil
+    end
+
+    # @param ids [Array<String>, nil]
+    def projection=(ids)
+      @projection = ids.try{|xs| Parser::Projection.new(xs) }
     end
 
     def customize(&block)
@@ -6,6 +6,9 @@ module Stupidedi
     class CodeListConfig
       include Inspect
 
+      # @return [Hash<String, Proc, CodeList>]
+      attr_reader :table
+
       def initialize
         @table = Hash.new
       end
@@ -14,8 +17,12 @@ module Stupidedi
         tap(&block)
       end
 
-      def register(id, &constructor)
-        @table[id] = constructor
+      def register(id, definition = nil, &constructor)
+        if block_given?
+          @table[id] = constructor
+        else
+          @table[id] = definition
+        end
       end
 
       def defined_at?(id)
@@ -23,7 +30,8 @@ module Stupidedi
       end
 
       def at(id)
-        @table[id].call
+        x = @table[id]
+        x.is_a?(Proc) ? x.call : x
       end
 
       # @return [void]
@@ -6,6 +6,9 @@ module Stupidedi
     class EditorConfig
       include Inspect
 
+      # @return [Hash<Object, Proc, Class>]
+      attr_reader :table
+
       def initialize
         @table = Hash.new
       end
@@ -25,8 +28,12 @@ module Stupidedi
       end
 
       # @param [Class, String] definition
-      def register(definition, &constructor)
-        @table[definition] = constructor
+      def register(definition, editor = nil, &constructor)
+        if block_given?
+          @table[definition] = constructor
+        else
+          @table[definition] = editor
+        end
       end
 
       # @param [Class] definition
@@ -37,7 +44,8 @@ module Stupidedi
 
       # @param [Class] definition
       def at(definition)
-        (@table.at(definition) || @table.at(definition.class.name)).call
+        x = @table.at(definition) || @table.at(definition.class.name)
+        x.is_a?(Proc) ? x.call : x
       end
 
       # @return [void]
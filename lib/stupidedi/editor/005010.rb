@@ -24,6 +24,12 @@ module Stupidedi
         acc.tap { critique_gs(gs, acc) }
       end
 
+      # Critiques one transaction set (ST/SE), but not the edits that compare
+      # it to the other transaction sets in its functional group
+      def critique_transaction_set(st, acc)
+        acc.tap { critique_st(st, acc) }
+      end
+
     private
 
       def critique_gs(gs, acc)
@@ -4,211 +4,433 @@ module Stupidedi
 
   module Editor
     #
-    # Generates an FA 999 acknowledgement
+    # Writes an FA 999 implementation acknowledgement for each functional
+    # group, one transaction set response (AK2, IK3, IK4, IK5) at a time, as
+    # the transaction sets are critiqued by
+    # {TransmissionEd#each_transaction_set}. Nothing is kept from one
+    # transaction set to the next except the counts for AK9 and the position
+    # of the current functional group, so the results can be released as
+    # soon as they're written.
+    #
+    # A transaction set without an SE segment isn't yielded by the parser,
+    # and stays in the parse tree. It's rejected with IK502 code 2 before the
+    # next transaction set in its functional group, or when the group ends.
+    # A functional group without any transaction sets gets a 999 with only
+    # AK1 and AK9 segments.
+    #
+    # Only the ST through SE segments are written. The caller writes the ISA
+    # and GS segments before them, and the GE and IEA segments after, using
+    # {#count} for GE01.
+    #
+    # The acknowledgement code for each functional group is computed from
+    # the responses, from GE01 and GE02, and from any {AK905} results that
+    # were yielded. The edits of {TransmissionEd#critique} that compare the
+    # whole functional group aren't made.
+    #
+    # @example
+    #   ack = Stupidedi::Editor::ImplementationAck.new(io, separators)
+    #
+    #   machine, = editor.each_transaction_set(parser, reader, :retain => false) do |zipper, acc|
+    #     ack.write(zipper, acc)
+    #   end
+    #
+    #   ack.finish(machine.zipper.fetch)
     #
     class ImplementationAck
-      def initialize(zipper, builder)
-        @builder = builder
-        @zipper  = zipper
+      # @return [Reader::Separators]
+      attr_reader :separators
+
+      # The number of 999 transaction sets that have been written
+      #
+      # @return [Integer]
+      attr_reader :count
+
+      def initialize(io, separators, options = {})
+        raise Exceptions::OutputError,
+          "separators.segment cannot be blank" if separators.segment.blank?
+
+        raise Exceptions::OutputError,
+          "separators.element cannot be blank" if separators.element.blank?
+
+        raise Exceptions::OutputError,
+          "separators.component cannot be blank" if separators.component.blank?
+
+        @out        = io.is_a?(Writer::Buffer) ? io : Writer::Buffer.new(io)
+        @separators = separators
+        @version    = options.fetch(:version, "005010X231A1")
+        @control    = options.fetch(:control_number, 1)
+        @count      = 0
+        @at         = nil
+        @gs         = nil
+        @sets       = ObjectSpace::WeakMap.new
+
+        chars    = [separators.component, separators.repetition,
+                    separators.element, separators.segment].select(&:present?)
+        @pattern = Regexp.union(chars.join.split(//).uniq)
+      end
+
+      # Writes the AK2 loop of the transaction set at `zipper`, with an IK3
+      # for each segment in `acc` that has errors. When the transaction set
+      # belongs to a different functional group than the previous one, that
+      # group's AK9 and SE segments are written first, along with a 999 for
+      # each functional group between them, followed by the ST and AK1
+      # segments of the next one.
+      #
+      # @param zipper [Zipper::AbstractCursor]
+      # @param acc [ResultSet]
+      # @return [ImplementationAck]
+      def write(zipper, acc)
+        group = zipper.up
+
+        advance(zipper.root.node, [group.up.path.position, group.path.position])
+        unterminated(group.node, zipper.path.position)
+
+        transaction_set(zipper, acc)
+        @sets[zipper.node] = true
+        self
+      end
+
+      # Writes the AK9 and SE segments of the last functional group, and a
+      # 999 for each functional group after it, then flushes the output
+      #
+      # @param zipper [Zipper::AbstractCursor]
+      # @return [ImplementationAck]
+      def finish(zipper)
+        advance(zipper.root.node, nil)
+        @out.flush
+        self
       end
 
-      def generate
-        @builder.ST("999", @builder.blank, "005010X231")
+    private
+
+      # Closes the current functional group, and writes a 999 for each one
+      # after it, up to the one at `to` (the positions of its interchange
+      # and functional group), which is opened. When `to` is nil, every
+      # functional group after the current one is written.
+      def advance(root, to)
+        return if @at == to and not @gs.nil?
+
+        i, g = @at || [0, -1]
+        close(functional_group(root, @at)) unless @gs.nil?
+
+        last = to.nil? ? root.children.length - 1 : to.head
+
+        i.upto(last) do |n|
+          interchange = root.children.at(n)
+          next unless interchange.interchange?
+
+          children = interchange.children
+          start    = n == i ? g + 1 : 0
+          stop     = n == last && to ? to.last : children.length
+
+          start.upto(stop - 1) do |m|
+            next unless children.at(m).functional_group?
+
+            open(children.at(m), [n, m])
+            close(children.at(m))
+          end
+        end
+
+        open(functional_group(root, to), to) unless to.nil?
+      end
+
+      # @return [Values::FunctionalGroupVal]
+      def functional_group(root, at)
+        root.children.at(at.head).children.at(at.last)
+      end
+
+      def open(group, at)
+        @at       = at
+        @gs       = group.children.head
+        @segments = 0
+        @received = 0
+        @accepted = 0
+        @ak905s   = []
+        @st02     = "%04d" % @control
+
+        segment("ST", "999", @st02, @version)
 
         # GS01, GS06, and GS08 must all be present and valid. It is not clear
         # how to respond when these elements are not valid (eg not an allowed
-        # value, not a number, too longo too short, etc) because copying the
-        # value to AK1 generates an invalid AK1 segment.
-        @builder.AK1(gs.element(1), # GS01: Functional Identifier
-                     gs.element(6), # GS06: Group Control Number
-                     gs.element(8)) # GS08: Industry Identifier
-
-          # ST01, ST02, and ST03 must all be present and valid. Like the AK1/GS
-          # paradox, there isn't a way to generate a valid response when the
-          # elements being acknowledged are not valid.
-          @builder.AK2(st.element(1), # ST01: Transaction Set Identifier Code
-                       st.element(2), # ST02: Transaction Set Control Number
-                       st.element(3)) # ST03: Implementation Guide Version
-
-            # M ID(2/3), M N0(1/10), O AN(1/4), O ID(1/3)
-            @builder.IK3(segment_id, segment_pos, loop_id, error_code)
-            #  1: Unrecoginzed segment ID
-            #  2: Unexpected segment
-            #  3: Required segment missing
-            #  4: Loop occurs over maximum times
-            #  5: Segment exceeds maximum use
-            #  6: Segment not defined in transaction set
-            #  7: Segment not in proper sequence
-            #  8: Segment has data element errors
-            # I4: Implementation "not used" segment present
-            # I6: Implementation situationally required segment missing
-            # I7: Implementation loop occurs under minimum times
-            # I8: Implementation segment below minimum use
-            # I9: Implementation situationally "not used" segment present
-
-          ### Required when IK304 = "I..."
-          ##@builder.CTX(
-          ##  @builder.composite("SITUATIONAL TRIGGER"),
-          ##  segment_id,
-          ##  segment_pos,
-          ##  loop_id,
-          ##  # Following two composites are required if the failed requirement
-          ##  # relates to an individual element, otherwise do not send
-          ##  @builder.composite(element_pos, component_pos, repeated_pos),
-          ##  @builder.composite(element_ref, component_ref))
-
-          ##@builder.CTX(
-          ### @builder.composite("TRN02", trn.element(2))
-          ### @builder.composite("NM109", nm1.element(9))
-          ### @builder.composite("ENT01", ent.element(1))
-          ### @builder.composite("REF02", ref.element(2))
-          ### @builder.composite("CLM01", clm.element(1)))
-
-              # M C030, O N0(1/4), M ID(1/3), O AN(1/99)
-              @builder.IK4(
-                @builder.composite(element_pos, component_pos, repeated_pos),
-                element_ref,
-                error_code,
-                element_data)
-              # Required when IK304 = "8"
-              #   1: Required data element missing
-              #   2: Conditional required data element missing
-              #   3: Too many data elements
-              #   4: Data element too short
-              #   5: Data element too long
-              #   6: Invalid character in data element
-              #   7: Invalid code value
-              #   8: Invalid date
-              #   9: Invalid time
-              #  10: Exclusion condition violated
-              #  12: Too many repetitions
-              #  13: Too many components
-              # I10: Implementation "not used" data element present
-              # I11: Implementation too few repetitions
-              # I12: Implementation pattern match failure
-              # I13: Implementation situationally "not used" data element present
-              #  I6: Code value not used in implementation
-              #  I9: Implementation situationally required data element missing
-
-            ### Required when IK404 = "I..."
-            ##@builder.CTX(
-            ##  @builder.composite("SITUATIONAL TRIGGER"),
-            ##  segment_id,
-            ##  segment_pos,
-            ##  loop_id,
-            ##  @builder.composite(element_pos, component_pos, repeated_pos),
-            ##  @builder.composite(element_ref, component_ref))
-
-
-          @builder.IK5(
-            acknowledgement_code,
-            error_code,
-            error_code,
-            error_code,
-            error_code,
-            error_code)
-          # A: Accepted
-          # E: Accepted but errors were noted
-          # R: Rejected
-          #
-          #  1: Transaction set not supported
-          #  2: Transaction set trailer missing
-          #  3: Transaction set control number in header and trailer do not match
-          #  4: Number of included segments does not match actual count
-          #  5: One or more segments in error
-          #  6: Missing or invalid transaction set identifier
-          #  7: Missing or invalid transaction set control number
-          # 17: Security not supported
-          # 18: Transaction set not in functional group
-          # 19: Invalid transaction set implementation convention reference
-          # 23: Transaction set control number not unique within the functional group
-          # I5: Implementation one or more segments in error
-          # I6: Implementation convention not supported
-
-        @builder.AK9(
-          acknowledgement_code,
-          included_count,
-          received_count,
-          accepted_count,
-          error_code,
-          error_code,
-          error_code,
-          error_code,
-          error_code)
+        # value, not a number, too long or too short, etc) because copying
+        # the value to AK1 generates an invalid AK1 segment.
+        segment("AK1", data(@gs, 0), data(@gs, 5), data(@gs, 7))
+      end
+
+      #  1: Functional group not supported
+      #  2: Functional group version not supported
+      #  3: Functional group trailer missing
+      #  4: Group control number in the functional group header and trailer do not agree
+      #  5: Number of included transaction sets does not match actual count
+      #  6: Group control number violates syntax
+      # 16: Security not supported
+      # 19: Functional group control number not unique within interchange
+      def close(group)
+        unterminated(group, group.children.length)
+
+        ge    = group.children.last
+        ge    = nil unless ge.segment? and ge.valid? and ge.id == :GE
+        codes = @ak905s
+
+        if ge.nil?
+          codes   += ["3"]
+          included = @received
+        else
+          included = data(ge, 0)
+          codes   += ["5"] unless included.to_i == @received
+          codes   += ["4"] unless data(ge, 1).to_i == data(@gs, 5).to_i
+        end
+
+        codes = codes.uniq.take(5)
+
         # A: Accepted
-        # E: Accepted, but errors were found
         # P: Partially accepted, at least one transaction set was rejected
         # R: Rejected
-        #
-        #  1: Functional group not supported
-        #  2: Functional group version not supported
-        #  3: Functional group trailer missing
-        #  4: Group control number in the functional group header and trailer do not agree
-        #  5: Number of included transaction sets does not match actual count
-        #  6: Group control number violates syntax
-        # 16: Security not supported
-        # 19: Functional group control number not unique within interchange
+        code =
+          if codes.present? or (@accepted.zero? and @received.nonzero?)
+            "R"
+          elsif @accepted < @received
+            "P"
+          else
+            "A"
+          end
+
+        segment("AK9", code, included.to_s, @received.to_s, @accepted.to_s, *codes)
+        segment("SE", (@segments + 1).to_s, @st02)
 
-        @builder.ST(count, @builder.blank)
+        @gs       = nil
+        @count   += 1
+        @control += 1
       end
 
-    private
+      #  1: Transaction set not supported
+      #  2: Transaction set trailer missing
+      #  3: Transaction set control number in header and trailer do not match
+      #  4: Number of included segments does not match actual count
+      #  5: One or more segments in error
+      #  6: Missing or invalid transaction set identifier
+      #  7: Missing or invalid transaction set control number
+      # 23: Transaction set control number not unique within the functional group
+      # I6: Implementation convention not supported
+      def transaction_set(zipper, acc)
+        st     = first(zipper.node)
+        errors = []
+        codes  = []
 
-      def validate(node)
-        if node.element?
-          if node.simple?
-            unless node.valid?
-              # 6: Invalid character in data element
-              # 8: Invalid date
-              # 9: Invalid time
-            end
-              #   3: Too many data elements
-              # I10: Implementation "not used" data element present
-              # I11: Implementation too few repetitions
-              # I12: Implementation pattern match failure
-              #  I6: Code value not used in implementation
-
-            if node.empty?
-              #   1: Required data element missing
-              #   2: Conditional required data element missing
-              #  I9: Implementation situationally required data element missing
-            else
-              #  10: Exclusion condition violated
-              # I13: Implementation situationally "not used" data element present
-
-              if node.too_long?
-                # 5: Data element too long
-              elsif node.too_short?
-                # 4: Data element too short
-              end
-
-              # 7: Invalid code value
-              unless node.allowed?
-              end
+        acc.results.each do |r|
+          case r
+          when IK304, IK403 then errors << r
+          when IK502        then codes  << r.code
+          when AK905        then @ak905s << r.code
+          end
+        end
+
+        # ST01, ST02, and ST03 must all be present and valid. Like the AK1/GS
+        # paradox, there isn't a way to generate a valid response when the
+        # elements being acknowledged are not valid.
+        segment("AK2", data(st, 0), data(st, 1), data(st, 2))
+
+        unless errors.empty?
+          ik3(zipper.node, errors)
+          codes << "5"
+        end
+
+        codes = codes.uniq.take(5)
+
+        # A: Accepted
+        # R: Rejected
+        segment("IK5", codes.empty? ? "A" : "R", *codes)
+
+        @received += 1
+        @accepted += 1 if codes.empty?
+      end
+
+      # Writes an IK3 segment for each {IK304}, and one for each segment with
+      # {IK403} errors followed by their IK4 segments, ordered by the position
+      # of the segment
+      #
+      #  1: Unrecognized segment ID
+      #  2: Unexpected segment
+      #  3: Required segment missing
+      #  4: Loop occurs over maximum times
+      #  5: Segment exceeds maximum use
+      #  8: Segment has data element errors
+      # I7: Implementation loop occurs under minimum times
+      def ik3(transaction_set, errors)
+        ordinals = index(transaction_set, {}.compare_by_identity)
+        segments = {}.compare_by_identity
+        notes    = []
+
+        errors.each do |r|
+          if r.is_a?(IK304)
+            notes << [ik304(r, ordinals), []]
+          else
+            s = r.zipper
+            s = s.up until s.node.segment?
+
+            ik4s = segments[s.node] ||= begin
+              notes << [[s.node.id.to_s, ordinals[s.node], loop_id(s.up), "8"], []]
+              notes.last.last
             end
-          elsif node.repeated?
-              # 12: Too many repetitions
-          elsif node.composite?
-              # 13: Too many components
+
+            ik4s << r
           end
-        elsif node.segment?
-          if node.valid?
+        end
+
+        notes.sort_by.with_index{|(ik3, _), n| [ik3[1] || 0, n] }.each do |ik3, ik4s|
+          segment("IK3", *ik3.map(&:to_s))
+          ik4s.each{|r| ik4(r) }
+        end
+      end
+
+      # @return [Array]
+      def ik304(r, ordinals)
+        z = r.zipper
+
+        if r.missing.nil?
+          s = z.node.segment? ? z.node : first(z.node)
+          [s.id.to_s, ordinals[s], loop_id(z.node.segment? ? z.up : z), r.code]
+        else
+          # The missing child would have followed the last segment of the
+          # sibling before it, or the first segment of its parent
+          s  = z.node.definition.equal?(r.missing.parent) ? first(z.node) : last(z.node)
+          id = r.missing.loop? ? r.missing.entry_segment_use.id : r.missing.id
+          l  = r.missing.parent.loop? ? loop_id(r.missing.parent) : nil
+
+          [id.to_s, ordinals[s], l, r.code]
+        end
+      end
+
+      #   1: Required data element missing
+      #   2: Conditional required data element missing
+      #   4: Data element too short
+      #   5: Data element too long
+      #   6: Invalid character in data element
+      #   7: Invalid code value
+      #   8: Invalid date
+      # I10: Implementation "not used" data element present
+      def ik4(r)
+        z         = r.zipper
+        component = nil
+        repeat    = nil
+
+        if z.up.node.composite?
+          component = z.path.position + 1
+          z = z.up
+        end
+
+        if z.up.node.repeated?
+          repeat = z.path.position + 1
+          z = z.up
+        end
+
+        position  = [(z.path.position + 1).to_s, component.to_s, repeat.to_s]
+        reference = r.zipper.node.definition.id.to_s[/\AE(\d+)\z/, 1]
+
+        if r.code != "1" and (r.zipper.node.simple? or r.zipper.node.component?)
+          copy = r.zipper.node.to_x12.to_s[0, 99]
+          copy = nil if copy =~ @pattern
+        end
+
+        segment("IK4", position, reference.to_s, r.code, copy.to_s)
+      end
+
+      # Numbers each segment in the transaction set, starting from ST
+      #
+      # @return [Hash<Values::SegmentVal, Integer>]
+      def index(value, ordinals)
+        value.children.each do |child|
+          if child.segment?
+            ordinals[child] = ordinals.length + 1
           else
-            #  1: Unrecoginzed segment ID
-            #  2: Unexpected segment
-            #  6: Segment not defined in transaction set
-            #  7: Segment not in proper sequence
-            # I4: Implementation "not used" segment present
+            index(child, ordinals)
           end
-            #  3: Required segment missing
-            #  4: Loop occurs over maximum times
-            #  5: Segment exceeds maximum use
-            #  8: Segment has data element errors
-            # I6: Implementation situationally required segment missing
-            # I7: Implementation loop occurs under minimum times
-            # I8: Implementation segment below minimum use
-            # I9: Implementation situationally "not used" segment present
         end
+
+        ordinals
+      end
+
+      # Returns the first part of the loop id, like "2300", which is all that
+      # fits in IK303
+      #
+      # @return [String, nil]
+      def loop_id(x)
+        x = x.node.definition if x.respond_to?(:node)
+        x.id.to_s.split(" ").head.to_s[0, 4] if x.loop?
+      end
+
+      # Writes an AK2 loop for each transaction set before the `n`th child of
+      # `group` that wasn't written, because the parser didn't yield it
+      # without an SE segment. Each is rejected with IK502 code 2: Transaction
+      # set trailer missing.
+      def unterminated(group, n)
+        sets = []
+
+        while n > 0
+          child = group.children.at(n -= 1)
+          next unless child.transaction_set?
+          break if @sets.key?(child)
+          sets << child
+        end
+
+        sets.reverse_each do |transaction_set|
+          st = first(transaction_set)
+
+          segment("AK2", data(st, 0), data(st, 1), data(st, 2))
+          segment("IK5", "R", "2")
+
+          @sets[transaction_set] = true
+          @received += 1
+        end
+      end
+
+      # @return [Values::SegmentVal]
+      def first(value)
+        value = value.children.head until value.segment?
+        value
+      end
+
+      # @return [Values::SegmentVal]
+      def last(value)
+        value = value.children.last until value.segment?
+        value
+      end
+
+      # Returns the text of the `n`th element of `segment`, which is copied
+      # to the acknowledgement
+      #
+      # @return [String]
+      def data(segment, n)
+        x12 = segment.children.at(n).try(:to_x12).to_s
+
+        if x12 =~ @pattern
+          message = x12.scan(@pattern).uniq.map(&:inspect).join(", ")
+
+          raise Exceptions::OutputError,
+            "separator characters #{message} occur as data"
+        end
+
+        x12
+      end
+
+      # Writes a segment, omitting trailing empty elements and components.
+      # Each composite element is an `Array` of components.
+      def segment(id, *elements)
+        elements = elements.map do |e|
+          e.is_a?(Array) ? trim(e).join(@separators.component) : e.to_s
+        end
+
+        @out << id
+        trim(elements).each{|e| @out << @separators.element << e }
+        @out << @separators.segment
+
+        @segments += 1
+      end
+
+      # @return [Array<String>]
+      def trim(elements)
+        last = elements.rindex(&:present?)
+        last.nil? ? [] : elements.take(last + 1)
       end
     end
   end
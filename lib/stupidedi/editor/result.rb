@@ -80,6 +80,17 @@ module Stupidedi
 
     # 999 Implementation Acknowledgement
     class IK304 < Error
+      # The definition of the missing segment or loop, when the error is
+      # that a required one is missing. The zipper is the last segment or
+      # loop before it, or its parent when there isn't one
+      #
+      # @return [Schema::SegmentUse, Schema::LoopDef, nil]
+      attr_reader :missing
+
+      def initialize(zipper, action, code, reason, missing = nil)
+        super(zipper, action, code, reason)
+        @missing = missing
+      end
     end
 
     # 999 Implementation Acknowledgement
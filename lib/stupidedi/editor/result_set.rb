@@ -65,6 +65,52 @@ module Stupidedi
         @results << result
         @warns   << result
       end
+
+      # Returns a new ResultSet with the results from this one and each of
+      # `others`, ordered by their position in the input. Results that don't
+      # have a position stay after the result that precedes them.
+      #
+      # @return [ResultSet]
+      def merge(*others)
+        results = []
+
+        [self, *others].each do |set|
+          offset = 0
+
+          set.results.each do |result|
+            offset = position(result).try(:offset) || offset
+            results << [offset, results.length, result]
+          end
+        end
+
+        ResultSet.new.tap do |acc|
+          results.sort!.each{|_, _, result| acc.add(result) }
+        end
+      end
+
+    protected
+
+      # @return [void]
+      def add(result)
+        @results << result
+
+        case result
+        when TA105   then @ta105s << result
+        when AK905   then @ak905s << result
+        when IK304   then @ik304s << result
+        when IK403   then @ik403s << result
+        when IK502   then @ik502s << result
+        when Warning then @warns  << result
+        end
+      end
+
+    private
+
+      # @return [Reader::Position]
+      def position(result)
+        node = result.zipper.node
+        node.position if node.respond_to?(:position)
+      end
     end
   end
 end
@@ -144,10 +144,9 @@ module Stupidedi
               zipper.children.each{|z| recurse(z, acc) }
 
               d = zipper.node.definition
-              d.syntax_notes.each do |s|
-                zs = syntax_note_errors(s, zipper)
-                ex = s.reason(zipper) if zs.present?
-                zs.each{|c| acc.ik403(c, "R", "2", ex) }
+              d.syntax_note_evaluator.violations(zipper.node).each do |s|
+                ex = s.reason(zipper)
+                syntax_note_errors(s, zipper).each{|c| acc.ik403(c, "R", "2", ex) }
               end
             end
           end
@@ -162,10 +161,9 @@ module Stupidedi
             end
 
             zipper.node.definition.tap do |d_|
-              d_.syntax_notes.each do |s|
-                es = syntax_note_errors(s, zipper)
-                ex = s.reason(zipper) if es.present?
-                es.each{|c| acc.ik403(c, "R", "2", ex) }
+              d_.syntax_note_evaluator.violations(zipper.node).each do |s|
+                ex = s.reason(zipper)
+                syntax_note_errors(s, zipper).each{|c| acc.ik403(c, "R", "2", ex) }
               end
             end
           else
@@ -196,9 +194,9 @@ module Stupidedi
 
             if matches.blank? and child.required?
               if child.loop?
-                acc.ik304(last, "R", "I7", "missing #{child.id} loop")
+                acc.ik304(last, "R", "I7", "missing #{child.id} loop", child)
               else
-                acc.ik304(last, "R", "3", "missing #{child.id} segment")
+                acc.ik304(last, "R", "3", "missing #{child.id} segment", child)
               end
             elsif repeat < matches.length
               matches.drop(repeat.max).each do |c|
@@ -237,9 +235,9 @@ module Stupidedi
 
             if matches.blank? and child.required?
               if child.loop?
-                acc.ik304(last, "R", "I7", "missing #{child.id} loop")
+                acc.ik304(last, "R", "I7", "missing #{child.id} loop", child)
               else
-                acc.ik304(last, "R", "3", "missing #{child.id} segment")
+                acc.ik304(last, "R", "3", "missing #{child.id} segment", child)
               end
             elsif repeat < matches.length
               matches.drop(repeat.max).each do |c|
@@ -65,8 +65,145 @@ module Stupidedi
         end
       end
 
+      # Reads all input from `reader` like
+      # {Parser::StateMachine#each_transaction_set}, and critiques each
+      # transaction set as soon as its SE segment is read, instead of after
+      # the entire input is parsed. The cursor and the {ResultSet} of each
+      # transaction set are yielded in the same order as the input, and the
+      # results of every transaction set are returned in one {ResultSet},
+      # ordered by position.
+      #
+      # When `:workers` is greater than 1, transaction sets are critiqued by
+      # a pool of threads while the parser continues reading. Only the edits
+      # of each transaction set are made here; the interchange and functional
+      # group edits made by {#critique} need the entire parse tree.
+      #
+      # When `:retain` is false, the results of each transaction set are
+      # released after they're yielded, and an empty {ResultSet} is returned.
+      # Memory use then doesn't grow with the number of transaction sets, as
+      # when the block writes them with {ImplementationAck}.
+      #
+      # @note On MRI, only one thread runs Ruby code at a time, so workers
+      # don't use more than one core
+      #
+      # @example
+      #   machine, result, acc = editor.each_transaction_set(parser, reader, :workers => 4)
+      #
+      # @yieldparam [Zipper::AbstractCursor] zipper
+      # @yieldparam [ResultSet] acc
+      # @return [(Parser::StateMachine, Reader::Result, ResultSet)]
+      def each_transaction_set(parser, reader, options = {})
+        workers = options.fetch(:workers, 1)
+        retain  = options.fetch(:retain, true)
+        results = []
+
+        emit = lambda do |zipper, acc|
+          yield zipper, acc if block_given?
+          results << acc if retain
+        end
+
+        machine, result =
+          if workers <= 1
+            parser.each_transaction_set(reader, options) do |zipper, st|
+              emit.call(zipper, critique_transaction_set(st))
+            end
+          else
+            pipeline(parser, reader, options, workers, emit)
+          end
+
+        return machine, result, ResultSet.new.merge(*results)
+      end
+
+      # Critiques the transaction set of `st`, a {Parser::StateMachine}
+      # positioned on its ST segment, using the editor for its functional
+      # group version. Like {#critique}, nothing is done unless there's also
+      # an editor for its interchange version.
+      #
+      # @return [ResultSet]
+      def critique_transaction_set(st, acc = ResultSet.new)
+        st.parent.tap do |gs|
+          gs.parent.flatmap(&:segment).tap do |isa|
+            next if isa.node.invalid?
+            next unless config.editor.defined_at?(isa.node.definition.parent.parent)
+
+            gs.segment.tap do |x|
+              unless x.node.invalid?
+                envelope_def = x.node.definition.parent.parent
+
+                if config.editor.defined_at?(envelope_def)
+                  editor = config.editor.at(envelope_def)
+                  editor.new(config, received).critique_transaction_set(st, acc)
+                end
+              end
+            end
+          end
+        end
+
+        acc
+      end
+
     private
 
+      # Critiques each transaction set on one of `workers` threads while the
+      # parser continues reading, and calls `emit` with each transaction set
+      # and its {ResultSet} in the same order as the input
+      #
+      # @return [(Parser::StateMachine, Reader::Result)]
+      def pipeline(parser, reader, options, workers, emit)
+        queue    = SizedQueue.new(workers * 2)
+        done     = Queue.new
+        zippers  = []
+        finished = {}
+        emitted  = 0
+
+        threads = workers.times.map do
+          Thread.new do
+            while job = queue.pop
+              n, st = job
+
+              done <<
+                begin
+                  [n, critique_transaction_set(st)]
+                rescue Exception => e
+                  [n, e]
+                end
+            end
+          end
+        end
+
+        # Waits for `count` transaction sets to be critiqued, then emits the
+        # ones that are next in order
+        collect = lambda do |count|
+          until count.zero? and done.empty?
+            n, acc = done.pop
+            raise acc if acc.is_a?(Exception)
+
+            finished[n] = acc
+            count      -= 1 unless count.zero?
+          end
+
+          while finished.key?(emitted)
+            emit.call(zippers.at(emitted), finished.delete(emitted))
+            zippers[emitted] = nil
+            emitted += 1
+          end
+        end
+
+        begin
+          machine, result = parser.each_transaction_set(reader, options) do |zipper, st|
+            queue << [zippers.length, st]
+            zippers << zipper
+            collect.call(0)
+          end
+
+          collect.call(zippers.length - emitted - finished.length)
+          return machine, result
+        ensure
+          queue.close
+          threads.each(&:join)
+        end
+      end
+
       #
       # @see FiveOhOne#critique
       #
@@ -32,7 +32,7 @@ module Stupidedi
       class SpecialVal < StringVal
         class Empty < StringVal::Empty
           # @return [String]
-          def to_x12
+          def to_x12(truncate = true)
             " " * definition.min_length
           end
         end
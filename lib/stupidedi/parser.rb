@@ -1,6 +1,7 @@
 # frozen_string_literal: true
 module Stupidedi
   module Parser
+    autoload :Cache,                "stupidedi/parser/cache"
     autoload :ConstraintTable,      "stupidedi/parser/constraint_table"
     autoload :Instruction,          "stupidedi/parser/instruction"
     autoload :InstructionTable,     "stupidedi/parser/instruction_table"
@@ -11,6 +12,11 @@ module Stupidedi
     autoload :Tokenization,         "stupidedi/parser/tokenization"
     autoload :StateMachine,         "stupidedi/parser/state_machine"
     autoload :IdentifierStack,      "stupidedi/parser/identifier_stack"
+    autoload :Parallel,             "stupidedi/parser/parallel"
+    autoload :Projection,           "stupidedi/parser/projection"
+    autoload :Instrumentation,      "stupidedi/parser/instrumentation"
+    autoload :EnvelopeIndex,        "stupidedi/parser/envelope_index"
+    autoload :Snapshot,             "stupidedi/parser/snapshot"
 
     autoload :AbstractState,        "stupidedi/parser/states/abstract_state"
     autoload :FailureState,         "stupidedi/parser/states/failure_state"
@@ -28,5 +34,56 @@ module Stupidedi
     def build(*args)
       Parser::StateMachine.build(*args)
     end
+
+    # Computes the {Instruction} lists for each interchange, functional group,
+    # and transaction set definition registered in `config`, and each of the
+    # tables and loops they contain. These are cached for the entire process
+    # (see {Parser::Cache}), so this can be called once when an application
+    # boots to avoid loading definitions while the first input is parsed.
+    #
+    # When one or more GS08 versions (eg, "005010X222A1") are given, only the
+    # transaction sets registered for those versions are loaded; otherwise
+    # every transaction set is loaded, including deprecated ones.
+    #
+    # The {InstructionTable}s that combine these lists depend on the input,
+    # so they are built on first use, and are then shared by every parser.
+    #
+    # @example
+    #   Parser.precompile(Config.hipaa, "005010X222A1", "005010X221A1")
+    #
+    # @return [Config]
+    def precompile(config, *versions)
+      config.interchange.table.each_key do |version|
+        Parser::InterchangeState.send(:instructions,
+          config.interchange.at(version))
+      end
+
+      config.functional_group.table.each_key do |version|
+        Parser::FunctionalGroupState.send(:instructions,
+          config.functional_group.at(version))
+      end
+
+      config.transaction_set.table.each_key do |key|
+        next unless versions.empty? or versions.include?(key.first)
+
+        transaction_set_def = config.transaction_set.at(*key)
+        Parser::TransactionSetState.send(:instructions, transaction_set_def)
+
+        transaction_set_def.table_defs.each do |table_def|
+          Parser::TableState.send(:instructions, table_def)
+          table_def.loop_defs.each{|l| precompile_loop(l) }
+        end
+      end
+
+      config
+    end
+
+  private
+
+    # @return [void]
+    def precompile_loop(loop_def)
+      Parser::LoopState.send(:instructions, loop_def)
+      loop_def.loop_defs.each{|l| precompile_loop(l) }
+    end
   end
 end
@@ -21,11 +21,26 @@ module Stupidedi
 
       def_delegators :@machine, :pretty_print, :segment, :element, :zipper, :successors, :empty?, :first?, :last?, :deterministic?
 
-      def initialize(machine, strict = true)
-        @machine = machine
-        @strict  = strict
-        @reader  = DslReader.new(Reader::Separators.empty,
-                                 Reader::SegmentDict.empty)
+      # The `options` are
+      #
+      # * `:positions`, when false, skips capturing the caller's file and
+      #   line for each segment and element, which requires a backtrace.
+      #   Segments have no position, except that when a segment is rejected
+      #   it's inserted again with the caller's position to build the error.
+      #
+      # * `:writer`, a {Writer::Stream} that each transaction set is written
+      #   to as soon as its SE segment is added. The transaction set is then
+      #   removed from the parse tree, so memory use doesn't grow with the
+      #   number of transaction sets. Call {#finish} after the last segment.
+      #
+      # @see BuilderDsl.stream
+      def initialize(machine, strict = true, options = {})
+        @machine   = machine
+        @strict    = strict
+        @positions = options.fetch(:positions, true)
+        @writer    = options[:writer]
+        @reader    = DslReader.new(Reader::Separators.empty,
+                                   Reader::SegmentDict.empty)
       end
 
       def respond_to_missing?(name, include_private = false)
@@ -90,17 +105,57 @@ module Stupidedi
           end
         end
 
+        if @writer and segment_tok.id == :SE and machine.deterministic?
+          machine = machine.discard_transaction_set do |zipper, _|
+            # The transaction set won't be terminated by a later segment,
+            # which is when it would otherwise be critiqued
+            if @strict
+              p = machine.active.head.node.zipper
+
+              begin
+                p = p.up
+                critique(p)
+              end until p.node.transaction_set?
+            end
+
+            @writer.write(zipper)
+          end
+        end
+
         @machine = machine
         @reader  = reader
 
         self
       end
 
+      # Writes the envelope segments and any transaction sets that haven't
+      # been written to the {Writer::Stream}, and flushes it
+      #
+      # @return [BuilderDsl]
+      def finish
+        @writer.finish(@machine.zipper.fetch) unless @writer.nil?
+        self
+      end
+
     private
 
+      def positions?
+        @positions
+      end
+
       def method_missing(name, *args)
         if SEGMENT_ID =~ name.to_s
-          segment!(name, Reader::Position.caller(2), *args)
+          if @positions
+            segment!(name, Reader::Position.caller(2), *args)
+          else
+            begin
+              segment!(name, nil, *args)
+            rescue Exceptions::ParseError
+              # Insert it again, so the error has the caller's position. The
+              # rescue clause adds a frame to the backtrace.
+              segment!(name, Reader::Position.caller(3), *args)
+            end
+          end
         else
           super
         end
@@ -152,11 +207,9 @@ module Stupidedi
               end
 
               d = zipper.node.definition
-              d.syntax_notes.each do |s|
-                unless s.satisfied?(zipper)
-                  raise Exceptions::ParseError,
-                    "for #{zipper.node.descriptor}, #{s.reason(zipper)} at #{zipper.node.position.inspect}"
-                end
+              d.syntax_note_evaluator.violations(zipper.node).each do |s|
+                raise Exceptions::ParseError,
+                  "for #{zipper.node.descriptor}, #{s.reason(zipper)} at #{zipper.node.position.inspect}"
               end
             end
           end
@@ -185,10 +238,9 @@ module Stupidedi
             end
 
             d = zipper.node.definition
-            d.syntax_notes.each do |s|
+            d.syntax_note_evaluator.violations(zipper.node).each do |s|
               raise Exceptions::ParseError,
-                "for #{zipper.node.descriptor}, #{s.reason(zipper)} at #{zipper.node.position.inspect}" \
-                unless s.satisfied?(zipper)
+                "for #{zipper.node.descriptor}, #{s.reason(zipper)} at #{zipper.node.position.inspect}"
             end
           end
 
@@ -261,6 +313,30 @@ module Stupidedi
         new(StateMachine.build(config), strict)
       end
 
+      # Returns a {BuilderDsl} for generating large outbound files, which
+      # writes each transaction set to `output` as soon as it's complete
+      # instead of keeping the whole parse tree, and doesn't capture the
+      # caller's position for each segment. The tree is built with
+      # {Zipper::Builder}, and {Parser.precompile} can compute the
+      # instruction tables before the first segment is added.
+      #
+      # Validation is disabled unless `strict` is true. Call {#finish} after
+      # the last segment to write the trailers and flush `output`.
+      #
+      # @example
+      #   b = BuilderDsl.stream(config, io, Reader::Separators.build(:segment => "~\n", :element => "*"))
+      #   b.ISA(...)
+      #   ...
+      #   b.IEA(...)
+      #   b.finish
+      #
+      # @return [BuilderDsl]
+      def stream(config, output, separators = Reader::Separators.empty, strict = false)
+        new(StateMachine.build(config, Zipper::Builder), strict,
+          :positions => false,
+          :writer    => Writer::Stream.new(output, separators))
+      end
+
       # @endgroup
       #########################################################################
     end
@@ -0,0 +1,112 @@
+# frozen_string_literal: true
+require "monitor"
+
+module Stupidedi
+  using Refinements
+
+  module Parser
+    #
+    # Process-wide memoization for the parser's derived data structures, like
+    # the {Instruction} lists for each definition, the {InstructionTable} they
+    # are pushed onto, and the {ConstraintTable} basis for each segment id.
+    #
+    # Definitions are shared by every parser built from the same {Config}, so
+    # entries are keyed by the identity of the {Schema::SegmentUse},
+    # {Schema::LoopDef}, etc. and each value is computed once per process no
+    # matter how many parsers (or threads) are reading.
+    #
+    # Lookups that find an entry don't acquire the lock; only computing a new
+    # entry does, and the lock is reentrant because computing one entry can
+    # depend on computing another. This relies on MRI's global VM lock, which
+    # keeps a `Hash` from being read while another thread inserts into it.
+    # On other Ruby implementations, every lookup acquires the lock.
+    #
+    # Entries are kept until {.clear} is called, so an application that
+    # builds many short-lived definitions (rather than sharing a {Config})
+    # should call it from time to time.
+    #
+    # The tables can't be shared with other Ractors, so a parser running
+    # outside the main Ractor fills its own tables, which are kept for the
+    # lifetime of that Ractor.
+    #
+    module Cache
+      LOCK = Monitor.new
+
+      # @private
+      GVL = RUBY_ENGINE == "ruby"
+
+      # @private
+      TABLES = {}.compare_by_identity
+
+      # @private
+      RACTOR_KEY = :"stupidedi.parser.cache"
+    end
+
+    class << Cache
+      # Returns the value stored in `table` at `key`, or stores and returns
+      # the value of the block, which is evaluated at most once per key
+      #
+      # @return [Object]
+      def fetch(table, key)
+        return lock.synchronize{ table.fetch(key){ table[key] = yield } } unless Cache::GVL
+
+        table.fetch(key) do
+          lock.synchronize do
+            table.fetch(key){ table[key] = yield }
+          end
+        end
+      end
+
+      # Returns the process-wide `Hash` that belongs to `owner`
+      #
+      # @return [Hash]
+      def table(owner)
+        return lock.synchronize{ tables[owner] ||= Hash.new } unless Cache::GVL
+
+        tables.fetch(owner) do
+          lock.synchronize do
+            tables[owner] ||= Hash.new
+          end
+        end
+      end
+
+      # Removes every process-wide table, so the entries for definitions that
+      # are no longer used can be collected. Parsers that were already built
+      # keep the instructions they refer to, and new parsers compute them
+      # again, like the first parse after loading, or {Parser.precompile}.
+      #
+      # Only the tables of the current Ractor are removed.
+      #
+      # @return [void]
+      def clear
+        lock.synchronize{ tables.clear }
+      end
+
+      # @return [Object]
+      def synchronize(&block)
+        lock.synchronize(&block)
+      end
+
+    private
+
+      # @return [Hash]
+      def tables
+        main? ? Cache::TABLES : local.first
+      end
+
+      # @return [Monitor]
+      def lock
+        main? ? Cache::LOCK : local.last
+      end
+
+      def main?
+        not defined?(Ractor) or Ractor.current.equal?(Ractor.main)
+      end
+
+      # @return [(Hash, Monitor)]
+      def local
+        Ractor.current[Cache::RACTOR_KEY] ||= [{}.compare_by_identity, Monitor.new]
+      end
+    end
+  end
+end
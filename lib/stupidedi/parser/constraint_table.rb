@@ -116,14 +116,14 @@ module Stupidedi
         def initialize(instructions)
           @instructions = instructions
           @__basis      = {}
+          @__narrow     = {}
         end
 
         # @return [Array<Instruction>]
         def matches(segment_tok, strict, mode)
-          invalid = true  # Were all present possibly distinguishing elements invalid?
           present = false # Were any possibly distinguishing elements present?
 
-          disjoint, distinct = basis(@instructions, mode)
+          disjoint, distinct, ordered = basis(@instructions, mode)
 
           # First check single elements that can narrow the search space to
           # a single matching Instruction.
@@ -155,11 +155,37 @@ module Stupidedi
           # If we reach this line, none of the present elements could, on its
           # own, narrow the search space to a single Instruction. We now test
           # the combination of elements to iteratively narrow the search space
-          space = @instructions
+          return narrow(segment_tok, distinct, ordered, present, strict) if strict
+
+          # The result only depends on which subset of instructions each value
+          # maps to, and the same combination tends to repeat (eg, for every
+          # claim in an 837), so it's memoized. The number of subsets of each
+          # map is bounded by its size, unlike the number of values
+          key = [mode, present]
+          distinct.each do |(n, m), map|
+            value = deconstruct(segment_tok.element_toks, n, m)
+            key << (value.nil? ? nil : map.at(value).object_id)
+          end
+
+          Cache.fetch(@__narrow, key) do
+            narrow(segment_tok, distinct, ordered, present, strict)
+          end
+        end
+
+        # @return [Array<Instruction>]
+        def narrow(segment_tok, distinct, ordered, present, strict)
+          # When the elements don't contradict each other, intersecting every
+          # subset gives the same result in any order, so the filters that
+          # leave the fewest instructions go first (see #sort_distinct). When
+          # they do, the loop below decides in the order of the elements
+          unless strict
+            space = intersect(segment_tok, ordered, present)
+            return space unless space.nil?
+          end
+
+          invalid = true  # Were all present possibly distinguishing elements invalid?
+          space   = @instructions
 
-          # @todo: These filters could be ordered by probable effectiveness,
-          # so we narrow the search space by the largest amount in the fewest
-          # number of steps.
           distinct.each do |(n, m), map|
             value = deconstruct(segment_tok.element_toks, n, m)
 
@@ -211,6 +237,31 @@ module Stupidedi
           end
         end
 
+        # Intersects the subsets of instructions allowed by each element in
+        # the segment, or returns nil when no instruction is allowed by all
+        # of them
+        #
+        # @return [Array<Instruction>]
+        def intersect(segment_tok, ordered, present)
+          invalid = true
+          space   = @instructions
+
+          ordered.each do |(n, m), map|
+            value = deconstruct(segment_tok.element_toks, n, m)
+            next if value.nil?
+
+            subset  = map.at(value)
+            present = true
+            next if subset.blank?
+
+            invalid = false
+            space  &= subset
+            return nil if space.empty?
+          end
+
+          (invalid and present) ? [] : space
+        end
+
         # Resolve conflicts between instructions that have identical SegmentUse
         # values. For each SegmentUse, this chooses the Instruction that pops
         # the fewest number of states.
@@ -224,9 +275,9 @@ module Stupidedi
           end
         end
 
-        # @return [Array(Array<(Integer, Integer, Map)>, Array<(Integer, Integer, Map)>)]
+        # @return [Array(Array<(Integer, Integer, Map)>, Array<(Integer, Integer, Map)>, Array<(Integer, Integer, Map)>)]
         def basis(instructions, mode)
-          @__basis[mode] ||= begin
+          Cache.fetch(@__basis, mode) do
             # When inserting segments, given a choice between two otherwise
             # equivalent instructions, prefer the one with smallest `pop_count`.
             # For example, when inserting an HL*20 in X221 835, the new 2000A
@@ -321,10 +372,22 @@ module Stupidedi
               end
             end
 
-            [disjoint_elements, distinct_elements]
+            [disjoint_elements, distinct_elements, sort_distinct(distinct_elements)]
           end
         end
 
+        # Orders the distinct filters so the ones that leave the fewest
+        # instructions, on average over the values each one maps, come first.
+        # Filters that are equally effective keep their order.
+        #
+        # @return [Array<(Integer, Integer, Map)>]
+        def sort_distinct(distinct_elements)
+          distinct_elements.each_with_index.sort_by do |((_, map), k)|
+            subsets = map.values + [map.default]
+            [subsets.sum(&:length).fdiv(subsets.length), k]
+          end.map(&:first)
+        end
+
         # @return [Hash<String, Array<Instruction>>]
         def build_disjoint(total, n, m, instructions)
           if total.finite?
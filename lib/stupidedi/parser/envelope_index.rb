@@ -0,0 +1,385 @@
+# frozen_string_literal: true
+require "stringio"
+
+module Stupidedi
+  using Refinements
+
+  module Parser
+    #
+    # Lists the interchanges, functional groups, and transaction sets of an
+    # input with their control numbers, versions, and byte offsets, without
+    # parsing their contents. The first ISA segment is read by
+    # {Reader::StreamReader} to find the separators, as is any ISA segment
+    # that doesn't immediately follow an interchange with the same ones. The
+    # segments that follow are only examined far enough to find the GS, ST,
+    # SE, GE, and IEA segments. The other segments are skipped by jumping to
+    # the next segment terminator, so this runs at about the speed of reading
+    # the input.
+    #
+    # Offsets count bytes from the start of the input, which is read as
+    # `ASCII-8BIT` (see {Reader::Input.binary}), so the entries can be used to
+    # seek to a transaction set or to divide the input among workers. The
+    # length of each entry includes its trailer segment and terminator, and
+    # is nil when the trailer is missing.
+    #
+    # @example
+    #   index = Parser::EnvelopeIndex.build(File.open(path))
+    #
+    #   index.transaction_sets.map do |st|
+    #     [st.functional_group.interchange.control_number,
+    #      st.functional_group.control_number, st.control_number, st.offset, st.length]
+    #   end
+    #
+    class EnvelopeIndex
+      include Inspect
+
+      # The number of bytes examined at a time when looking for an ISA segment
+      WINDOW = 4096
+
+      class Interchange
+        include Inspect
+
+        # @return [Integer]
+        attr_reader :offset
+
+        # @return [Integer, nil]
+        attr_reader :length
+
+        # The ISA segment, without its terminator
+        #
+        # @return [String]
+        attr_reader :segment
+
+        # The element separator and segment terminator
+        #
+        # @return [Reader::Separators]
+        attr_reader :separators
+
+        # ISA12: Interchange Control Version Number
+        #
+        # @return [String]
+        attr_reader :version
+
+        # ISA13: Interchange Control Number
+        #
+        # @return [String]
+        attr_reader :control_number
+
+        # @return [Array<FunctionalGroup>]
+        attr_reader :functional_groups
+
+        def initialize(offset, segment, separators, elements)
+          @offset, @segment, @separators =
+            offset, segment, separators
+
+          @version, @control_number =
+            elements.at(12), elements.at(13)
+
+          @functional_groups = []
+        end
+
+        # @private
+        # @return [void]
+        def finish(offset)
+          @length = offset - @offset
+        end
+      end
+
+      class FunctionalGroup
+        include Inspect
+
+        # @return [Interchange]
+        attr_reader :interchange
+
+        # @return [Integer]
+        attr_reader :offset
+
+        # @return [Integer, nil]
+        attr_reader :length
+
+        # The GS segment, without its terminator
+        #
+        # @return [String]
+        attr_reader :segment
+
+        # GS01: Functional Identifier Code
+        #
+        # @return [String]
+        attr_reader :functional_identifier
+
+        # GS06: Group Control Number
+        #
+        # @return [String]
+        attr_reader :control_number
+
+        # GS08: Version / Release / Industry Identifier Code
+        #
+        # @return [String]
+        attr_reader :version
+
+        # @return [Array<TransactionSet>]
+        attr_reader :transaction_sets
+
+        def initialize(interchange, offset, segment, elements)
+          @interchange, @offset, @segment =
+            interchange, offset, segment
+
+          @functional_identifier, @control_number, @version =
+            elements.at(1), elements.at(6), elements.at(8)
+
+          @transaction_sets = []
+        end
+
+        # @private
+        # @return [void]
+        def finish(offset)
+          @length = offset - @offset
+        end
+      end
+
+      class TransactionSet
+        include Inspect
+
+        # @return [FunctionalGroup]
+        attr_reader :functional_group
+
+        # @return [Integer]
+        attr_reader :offset
+
+        # @return [Integer, nil]
+        attr_reader :length
+
+        # ST01: Transaction Set Identifier Code
+        #
+        # @return [String]
+        attr_reader :identifier
+
+        # ST02: Transaction Set Control Number
+        #
+        # @return [String]
+        attr_reader :control_number
+
+        # ST03: Implementation Convention Reference
+        #
+        # @return [String, nil]
+        attr_reader :implementation
+
+        def initialize(functional_group, offset, elements)
+          @functional_group, @offset =
+            functional_group, offset
+
+          @identifier, @control_number, @implementation =
+            elements.at(1), elements.at(2), elements.at(3)
+        end
+
+        # @private
+        # @return [void]
+        def finish(offset)
+          @length = offset - @offset
+        end
+      end
+
+      # @return [Array<Interchange>]
+      attr_reader :interchanges
+
+      def initialize(interchanges)
+        @interchanges = interchanges
+      end
+
+      # @return [Array<FunctionalGroup>]
+      def functional_groups
+        @interchanges.flat_map(&:functional_groups)
+      end
+
+      # @return [Array<TransactionSet>]
+      def transaction_sets
+        @interchanges.flat_map{|isa| isa.functional_groups.flat_map(&:transaction_sets) }
+      end
+
+      # @return [Boolean]
+      def empty?
+        @interchanges.empty?
+      end
+    end
+
+    class << EnvelopeIndex
+      # @group Constructors
+      #########################################################################
+
+      # Scans `input`, a `String` or `IO`. An `IO` without a path is read into
+      # memory first, because the scan seeks back to the start of each
+      # interchange.
+      #
+      # @return [EnvelopeIndex]
+      def build(input)
+        io =
+          case input
+          when String
+            StringIO.new(Reader::Input.binary(input))
+          when IO
+            input.respond_to?(:path) && input.path ?
+              Reader::Input.binary(input) : StringIO.new(input.read.b)
+          else
+            raise TypeError, "input must be a String or IO"
+          end
+
+        interchanges = []
+        interchange  = interchange_at(io, 0)
+
+        until interchange.nil?
+          interchanges << interchange
+          offset = scan(io, interchange)
+          break if offset.nil?
+
+          interchange = next_interchange(io, offset, interchange.separators) ||
+                        interchange_at(io, offset)
+        end
+
+        EnvelopeIndex.new(interchanges)
+      end
+
+      # @endgroup
+      #########################################################################
+
+    private
+
+      # Returns the first interchange that starts at or after `offset`, or
+      # nil if no more ISA segments are found
+      #
+      # @return [EnvelopeIndex::Interchange]
+      def interchange_at(io, offset)
+        loop do
+          io.seek(offset)
+          window = io.read(EnvelopeIndex::WINDOW)
+          return nil if window.nil?
+
+          result = Reader::StreamReader.new(Reader::DelegatedInput.new(window, offset)).read_segment
+
+          if result.defined?
+            isa, tokenizer = result.fetch, result.remainder
+            separators     = tokenizer.separators
+            finish         = tokenizer.input.offset
+
+            # The position of the token follows the segment identifier
+            start = isa.position.offset - 3
+
+            segment = window.byteslice(start - offset, finish - start - 1)
+            io.seek(finish)
+
+            return EnvelopeIndex::Interchange.new(start, segment,
+              separators, segment.split(separators.element, -1))
+          end
+
+          return nil if window.bytesize < EnvelopeIndex::WINDOW
+
+          # The window may end in the middle of an ISA segment, which is 106
+          # bytes long without any control characters between its elements
+          offset += EnvelopeIndex::WINDOW / 2
+        end
+      end
+
+      # Reads the next segment like {#scan}, and returns its interchange if
+      # it's an ISA segment with the same separators as the previous one.
+      # Otherwise, {Reader::StreamReader} needs to find the next ISA segment
+      # and its separators, which is much slower.
+      #
+      # @return [EnvelopeIndex::Interchange, nil]
+      def next_interchange(io, offset, separators)
+        segment = io.gets(separators.segment)
+        return nil if segment.nil? or not segment.end_with?(separators.segment)
+
+        n = skip(segment)
+        return nil unless segment.byteslice(n, 4) == "ISA" + separators.element
+
+        text     = segment.byteslice(n, segment.bytesize - n - separators.segment.bytesize)
+        elements = text.split(separators.element, -1)
+
+        # ISA16 is the last element, and it holds one character. Otherwise,
+        # the next interchange doesn't use the same segment terminator.
+        return nil unless elements.length == 17 and elements.last.length == 1
+
+        EnvelopeIndex::Interchange.new(offset + n, text, separators, elements)
+      end
+
+      # Reads the segments of `interchange`, starting from the current
+      # position of `io` after its ISA segment, and returns the offset
+      # where the next interchange might start, or nil at the end of input
+      #
+      # @return [Integer, nil]
+      def scan(io, interchange)
+        terminator   = interchange.separators.segment
+        element      = interchange.separators.element
+        envelopes    = envelopes(element)
+        group, set   = nil, nil
+        offset       = io.pos
+
+        while segment = io.gets(terminator)
+          start   = offset
+          offset += segment.bytesize
+
+          # The last segment isn't complete
+          break unless segment.end_with?(terminator)
+
+          n = skip(segment)
+
+          case envelopes[segment.byteslice(n, 3)]
+          when :GS
+            text  = segment.byteslice(n, segment.bytesize - n - terminator.bytesize)
+            group = EnvelopeIndex::FunctionalGroup.new(interchange, start + n, text, text.split(element, -1))
+            interchange.functional_groups << group
+          when :ST
+            unless group.nil?
+              text = segment.byteslice(n, segment.bytesize - n - terminator.bytesize)
+              set  = EnvelopeIndex::TransactionSet.new(group, start + n, text.split(element, -1))
+              group.transaction_sets << set
+            end
+          when :SE
+            set.finish(offset) unless set.nil?
+            set = nil
+          when :GE
+            group.finish(offset) unless group.nil?
+            group, set = nil, nil
+          when :IEA
+            if envelope?(segment, n, element, terminator)
+              interchange.finish(offset)
+              return offset
+            end
+          when :ISA
+            # Another interchange begins before this one ended
+            if envelope?(segment, n, element, terminator)
+              io.seek(start)
+              return start
+            end
+          end
+        end
+
+        nil
+      end
+
+      # Returns the number of control characters, like newlines, that
+      # precede the segment identifier
+      #
+      # @return [Integer]
+      def skip(segment)
+        n = 0
+        n += 1 while (c = segment.getbyte(n)) and (c < 0x20 or c == 0x7F)
+        n
+      end
+
+      # Maps the first three bytes of each envelope segment to its identifier
+      #
+      # @return [Hash<String, Symbol>]
+      def envelopes(element)
+        { "GS" + element => :GS, "ST" + element => :ST, "SE" + element => :SE,
+          "GE" + element => :GE, "IEA" => :IEA, "ISA" => :ISA }
+      end
+
+      # True if the three letter segment identifier at `n` is followed by a
+      # separator, so "IEA" isn't confused with a longer identifier
+      def envelope?(segment, n, element, terminator)
+        c = segment.byteslice(n + 3, 1)
+        c == element or c == terminator
+      end
+    end
+  end
+end
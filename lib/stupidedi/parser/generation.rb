@@ -23,54 +23,207 @@ module Stupidedi
       #
       # @return [(StateMachine, Reader::Result)]
       def read(reader, options = {})
-        limit    = options.fetch(:nondeterminism, 1)
-        machine  = self
-        reader_e = reader.read_segment
+        __read(reader, options){|machine, _| machine }
+      end
 
-        while reader_e.defined?
-          reader_e = reader_e.flatmap do |segment_tok, reader_|
-            machine, reader__ =
-              machine.insert(segment_tok, false, reader_)
+      # Reads all input from `reader` like {#read}, but yields a cursor
+      # positioned at each transaction set as soon as its SE segment is read.
+      # The ancestors of the cursor hold the ISA and GS segments, but not the
+      # trailers, which haven't been read yet.
+      #
+      # After the block returns, the transaction set and its states are
+      # removed from the parse tree, so memory use depends on the size of the
+      # largest transaction set rather than the size of the input.
+      #
+      # The block is also given a {StateMachine} positioned on the ST segment
+      # of the transaction set, which can be navigated like the one returned
+      # by {#read} (see {Editor::TransmissionEd#each_transaction_set}).
+      #
+      # Transaction sets that don't end with an SE segment, or that end while
+      # the parser is nondeterministic, are not yielded and remain in the
+      # returned {StateMachine}.
+      #
+      # @example
+      #   parser.each_transaction_set(reader) do |zipper|
+      #     zipper.node #=> TransactionSetVal
+      #   end
+      #
+      # @yieldparam [Zipper::AbstractCursor] zipper
+      # @yieldparam [StateMachine] st
+      # @return [(StateMachine, Reader::Result)]
+      def each_transaction_set(reader, options = {})
+        __read(reader, options) do |machine, segment_tok|
+          if segment_tok.id == :SE and machine.deterministic?
+            machine.__discard_transaction_set{|zipper, st| yield zipper, st }
+          else
+            machine
+          end
+        end
+      end
 
-            if machine.active.length <= limit
-              reader__.read_segment
-            else
-              matches = machine.active.map do |m|
-                if segment_use = m.node.zipper.node.usage
-                  "SegmentUse(#{segment_use.position}, #{segment_use.id},
-                  #{segment_use.requirement.inspect}, #{segment_use.repeat_count.inspect})".join
-                else
-                  m.node.zipper.node.inspect
-                end
-              end.join(", ")
+      # Reads only the transaction set of `entry`, an
+      # {EnvelopeIndex::TransactionSet} from an index of `input`, which is
+      # the `String` or `IO` that was scanned. The ISA and GS segments held
+      # by the index are read first, to select the separators, segment
+      # dictionary, and transaction set definition, then the bytes from the
+      # ST segment through the SE segment are read from `input`. The
+      # returned {StateMachine} holds one interchange, functional group,
+      # and transaction set, without the GE and IEA segments.
+      #
+      # The offsets of the segments are the same as when reading the entire
+      # input, but lines and columns are counted from the start of the ISA,
+      # GS, or ST segment that was read before them.
+      #
+      # When the entry has no SE segment, the input is read until the end of
+      # its functional group or interchange, or the end of the input.
+      #
+      # @example
+      #   index = Parser::EnvelopeIndex.build(File.open(path))
+      #   entry = index.transaction_sets.find{|st| st.control_number == "0042" }
+      #
+      #   machine, result = parser.read_transaction_set(File.open(path), entry)
+      #
+      # @return [(StateMachine, Reader::Result)]
+      def read_transaction_set(input, entry, options = {})
+        group       = entry.functional_group
+        interchange = group.interchange
+        terminator  = interchange.separators.segment
 
-              return machine,
-                Reader::Result.failure("too much non-determinism: #{matches}", reader__.input, true)
-            end
-          end
+        machine, result = read(Reader.build(Reader::DelegatedInput.new(
+          interchange.segment + terminator, interchange.offset), options), options)
+
+        [[group.segment + terminator, group.offset],
+         [__transaction_set_bytes(input, entry), entry.offset]].each do |string, offset|
+          return machine, result unless machine.deterministic?
+
+          state  = machine.active.head.node
+          reader = Reader::TokenReader.new(Reader::DelegatedInput.new(string, offset),
+            state.separators, state.segment_dict)
+
+          machine, result = machine.read(reader, options)
         end
 
-        return machine, reader_e
+        return machine, result
       end
 
-      # @return [(StateMachine, Reader::TokenReader)]
-      def insert(segment_tok, strict, reader)
-        active = @active.flat_map do |zipper|
-          state        = zipper.node
-          instructions = state.instructions.matches(segment_tok, strict, :insert)
+      # Returns a new {StateMachine} for the parse tree of `zipper`, which is
+      # this machine's parse tree after it was edited using the methods of
+      # {Zipper::AbstractCursor}. Only the transaction sets that were changed
+      # are read again; a token is built from each of their segments and
+      # added from the state that precedes the transaction set, while the
+      # values and states of its siblings are reused. A single change to a
+      # large input costs about as much as reading the transaction set that
+      # contains it.
+      #
+      # The tokens are built from the element values, or are the tokens that
+      # invalid and {Values::RawSegmentVal} segments were read from, so no
+      # segments are left out the way {Writer::Default} leaves out segments
+      # with only empty elements. The segments keep their positions.
+      #
+      # Each transaction set that was read again is yielded like
+      # {#each_transaction_set}, so only those need to be critiqued again
+      # (see {Editor::TransmissionEd#critique_transaction_set}).
+      #
+      # When the interchange or functional group segments were changed, when
+      # transaction sets were added or removed, when a changed transaction
+      # set no longer ends like the original did, or when this machine isn't
+      # deterministic, every segment in the tree is read again, and every
+      # transaction set is yielded.
+      #
+      # @example
+      #   edited = machine.find(:CLP).flatmap{|m| m.element(1) }.map do |e|
+      #     e.replace(e.node.copy(:value => "5554555444"))
+      #   end
+      #
+      #   machine = machine.reparse(edited.fetch) do |zipper, st|
+      #     editor.critique_transaction_set(st, acc)
+      #   end
+      #
+      # @yieldparam [Zipper::AbstractCursor] zipper
+      # @yieldparam [StateMachine] st
+      # @return [StateMachine]
+      def reparse(zipper, &block)
+        return __reparse_all(zipper, &block) unless deterministic?
 
-          if instructions.empty?
-            zipper.append(FailureState.mksegment(segment_tok, state)).cons
-          else
-            instructions.map do |op|
-              successor = execute(op, zipper, reader, segment_tok)
-              reader    = update_reader(op, reader, successor)
-              successor
-            end
+        state  = @active.head
+        value  = state.node.zipper
+        active = __path(value)
+        paths  = []
+
+        unless __changes(value.root.node, zipper.root.node, [], paths) and
+          paths.none?{|p| active.take(p.length) == p }
+          return __reparse_all(zipper, &block)
+        end
+
+        edited = zipper.root
+
+        paths.each do |path|
+          state, value = __descendant(state.root, value.root, path)
+
+          # The successors of the SE segment, which must be the same after
+          # the transaction set is read again
+          last = state
+          last = last.down.last until last.leaf?
+          successors = last.node.instructions
+
+          value = value.delete.prev
+          state = state.delete.prev
+
+          # Synchronize the two parallel state and value nodes
+          unless value.eql?(state.node.zipper)
+            state = state.replace(state.node.copy(:zipper => value))
+          end
+
+          reader  = Reader::TokenReader.new("", state.node.separators, state.node.segment_dict)
+          machine = StateMachine.new(@config, state.cons).__replay(edited.descendant(*path).node, reader)
+
+          unless machine.deterministic? and
+            machine.active.head.node.instructions.equal?(successors)
+            return __reparse_all(zipper, &block)
+          end
+
+          previous = value.node
+          state    = machine.active.head
+          value    = state.node.zipper
+
+          until value.root? or value.node.transaction_set?
+            value = value.up
+            state = state.up
+          end
+
+          unless value.node.transaction_set? and value.prev.node.equal?(previous)
+            return __reparse_all(zipper, &block)
           end
         end
 
-        return StateMachine.new(@config, active), reader
+        state, value = __descendant(state.root, value.root, active)
+
+        # Synchronize the two parallel state and value nodes
+        unless value.eql?(state.node.zipper)
+          state = state.replace(state.node.copy(:zipper => value))
+        end
+
+        StateMachine.new(@config, state.cons).tap do |machine|
+          machine.__transaction_sets(paths, &block) if block
+        end
+      end
+
+      # @return [(StateMachine, Reader::TokenReader)]
+      def insert(segment_tok, strict, reader)
+        __insert(segment_tok, strict, reader, false)
+      end
+
+      # Yields a cursor positioned at the transaction set that contains the
+      # current segment, and a machine positioned on its ST segment, then
+      # returns a machine without that transaction set, like
+      # {#each_transaction_set} does after reading each SE segment. Returns
+      # `self` when the current segment isn't in a transaction set.
+      #
+      # @yieldparam [Zipper::AbstractCursor] zipper
+      # @yieldparam [StateMachine] st
+      # @return [StateMachine]
+      def discard_transaction_set(&block)
+        __discard_transaction_set(&block)
       end
 
       # Three things change together when executing an {Instruction}:
@@ -98,7 +251,7 @@ module Stupidedi
         if op.push.nil?
           # This instruction doesn't create a child node in the parse tree,
           # but it might move us forward to a sibling or upward to an uncle
-          segment = AbstractState.mksegment(segment_tok, op.segment_use)
+          segment = AbstractState.mksegment(segment_tok, op.segment_use, @config)
           value   = value.append(segment)
 
           # If we're moving upward, pop off the current table(s). If we're
@@ -142,6 +295,381 @@ module Stupidedi
           end
         end || reader
       end
+
+    protected
+
+      # When `in_place` is true and there is exactly one active state, which
+      # has exactly one matching instruction, this {StateMachine} is updated
+      # and returned instead of allocating a new one. This is only safe when
+      # no one else has a reference to it, like the machines created while
+      # reading in {#__read}. The state and value trees are then appended to
+      # with {Zipper::BuilderCursor}, like {Zipper::Builder} does, instead of
+      # copying the leftward siblings for each segment.
+      #
+      # @return [(StateMachine, Reader::TokenReader)]
+      def __insert(segment_tok, strict, reader, in_place)
+        instrumentation = @config.try(:instrumentation)
+        matched         = nil
+
+        if @active.length == 1
+          zipper  = @active.head
+          matched = __match(instrumentation, zipper.node, segment_tok, strict)
+
+          # Nearly all input is read with a single active state and a single
+          # matching instruction, so take a shortcut around the general case
+          if matched.length == 1
+            op        = matched.head
+            zipper    = __builder(zipper) if in_place
+            successor = __execute(instrumentation, op, zipper, reader, segment_tok)
+            reader    = update_reader(op, reader, successor)
+
+            if in_place
+              @active[0] = successor
+              return self, reader
+            else
+              return StateMachine.new(@config, successor.cons), reader
+            end
+          end
+        end
+
+        active = @active.flat_map do |zipper|
+          state        = zipper.node
+          instructions = matched || __match(instrumentation, state, segment_tok, strict)
+
+          if instructions.empty?
+            zipper.append(FailureState.mksegment(segment_tok, state)).cons
+          else
+            instructions.map do |op|
+              successor = __execute(instrumentation, op, zipper, reader, segment_tok)
+              reader    = update_reader(op, reader, successor)
+              successor
+            end
+          end
+        end
+
+        return StateMachine.new(@config, active), reader
+      end
+
+      # Converts the state cursor `zipper`, and the value cursor of its
+      # state, to {Zipper::BuilderCursor}s unless they already are. This only
+      # copies the leftward siblings after moving up to a node that wasn't
+      # built by a {Zipper::BuilderCursor}, like the root of a new machine.
+      #
+      # @return [Zipper::AbstractCursor]
+      def __builder(zipper)
+        state = Zipper::Builder.convert(zipper)
+        value = Zipper::Builder.convert(state.node.zipper)
+
+        if value.equal?(state.node.zipper)
+          state
+        else
+          state.replace(state.node.copy(:zipper => value))
+        end
+      end
+
+      # Yields the transaction set that contains the current segment, and a
+      # machine positioned on its first segment, then returns a new
+      # {StateMachine} with that transaction set and its states removed. The
+      # new machine is positioned on the segment that precedes the
+      # transaction set, which has the same successors as its SE segment.
+      #
+      # @return [StateMachine]
+      def __discard_transaction_set
+        state = @active.head
+        value = state.node.zipper
+
+        until value.root? or value.node.transaction_set?
+          value = value.up
+          state = state.up
+        end
+
+        return self if value.root?
+        yield value, __first_segment(state, value)
+
+        value = value.delete
+        state = state.delete
+
+        # Synchronize the two parallel state and value nodes
+        unless value.eql?(state.node.zipper)
+          state = state.replace(state.node.copy(:zipper => value))
+        end
+
+        StateMachine.new(@config, state.cons)
+      end
+
+      # Adds each segment below `value` to a copy of this machine, like
+      # {#__read} adds the segments it reads, and returns the copy
+      #
+      # @return [StateMachine]
+      def __replay(value, reader)
+        machine = copy(:active => @active.dup)
+
+        __each_segment(value) do |segment|
+          machine, reader = machine.__insert(__segment_tok(segment), false, reader, true)
+        end
+
+        machine
+      end
+
+      # Yields each transaction set at the given paths of child indexes from
+      # the root, and a machine positioned on its first segment
+      #
+      # @return [void]
+      def __transaction_sets(paths)
+        state = @active.head
+        value = state.node.zipper
+
+        paths.each do |path|
+          state, value = __descendant(state.root, value.root, path)
+          yield value, __first_segment(state, value)
+        end
+      end
+
+    private
+
+      # @return [void]
+      def __each_segment(value, &block)
+        if value.segment?
+          yield value
+        else
+          value.children.each{|c| __each_segment(c, &block) }
+        end
+      end
+
+      # Returns the token that `segment` was read from, or an equivalent one
+      # built from the text of its elements
+      #
+      # @return [Reader::SegmentTok]
+      def __segment_tok(segment)
+        return segment.segment_tok if segment.respond_to?(:segment_tok)
+
+        position = segment.position
+        elements = segment.children
+        count    = elements.length
+
+        # The parser builds elements that are missing from the end of the
+        # segment as empty values, so they're left out again
+        count -= 1 while count > 0 and __missing?(elements.at(count - 1))
+
+        Reader::SegmentTok.new(segment.id,
+          elements.take(count).map{|e| __element_tok(e, position) }, position, nil)
+      end
+
+      # @return [Boolean]
+      def __missing?(value)
+        if value.repeated? or value.composite?
+          value.children.empty?
+        else
+          value.empty?
+        end
+      end
+
+      # Elements without any children have no position of their own, so
+      # they're given `position`
+      #
+      # @return [Reader::SimpleElementTok, Reader::CompositeElementTok, Reader::RepeatedElementTok]
+      def __element_tok(value, position)
+        if value.repeated?
+          element_toks = value.children.map{|e| __element_tok(e, position) }
+          Reader::RepeatedElementTok.build(element_toks,
+            element_toks.empty? ? position : element_toks.last.position)
+        elsif value.composite?
+          component_toks = value.children.map do |c|
+            Reader::ComponentElementTok.build(Snapshot.text(c), c.position, nil)
+          end
+
+          Reader::CompositeElementTok.build(component_toks,
+            component_toks.empty? ? position : component_toks.head.position, nil)
+        else
+          Reader::SimpleElementTok.build(Snapshot.text(value), value.position, nil)
+        end
+      end
+
+      # Reads the bytes of the transaction set `entry` from `input`
+      #
+      # @return [String]
+      def __transaction_set_bytes(input, entry)
+        length = entry.length ||
+          [entry.functional_group, entry.functional_group.interchange].map do |e|
+            e.offset + e.length - entry.offset unless e.length.nil?
+          end.compact.head
+
+        case input
+        when String
+          input.byteslice(entry.offset, length || input.bytesize).b
+        when IO
+          if length.nil?
+            input.seek(entry.offset)
+            input.read
+          else
+            input.pread(length, entry.offset)
+          end.b
+        else
+          raise TypeError, "input must be a String or IO"
+        end
+      end
+
+      # Reads every segment in the tree of `zipper` again, then yields each
+      # of its transaction sets
+      #
+      # @return [StateMachine]
+      def __reparse_all(zipper)
+        reader  = Reader::TokenReader.new("", Reader::Separators.empty)
+        machine = StateMachine.build(@config).__replay(zipper.root.node, reader)
+
+        if block_given? and machine.deterministic?
+          paths = []
+          __changes(nil, machine.active.head.node.zipper.root.node, [], paths)
+          machine.__transaction_sets(paths){|z, st| yield z, st }
+        end
+
+        machine
+      end
+
+      # Adds the path of each transaction set in `edited` that isn't the same
+      # as the one in `original` to `paths`, and returns false when anything
+      # else is different
+      #
+      # @return [Boolean]
+      def __changes(original, edited, path, paths)
+        if original.equal?(edited)
+          true
+        elsif edited.transaction_set?
+          paths << path
+          original.nil? or original.transaction_set?
+        elsif edited.segment? or edited.invalid?
+          false
+        elsif original.nil?
+          edited.children.each_with_index{|c, n| __changes(nil, c, path + [n], paths) }
+        elsif original.class == edited.class and original.children.length == edited.children.length
+          edited.children.each_with_index.all?{|c, n| __changes(original.children.at(n), c, path + [n], paths) }
+        else
+          false
+        end
+      end
+
+      # The child indexes from the root to `zipper`
+      #
+      # @return [Array<Integer>]
+      def __path(zipper)
+        path = []
+
+        until zipper.root?
+          path.unshift(zipper.path.left.length)
+          zipper = zipper.up
+        end
+
+        path
+      end
+
+      # Descends the parallel state and value trees along `path`
+      #
+      # @return [(Zipper::AbstractCursor, Zipper::AbstractCursor)]
+      def __descendant(state, value, path)
+        path.each do |n|
+          state = state.child(n)
+          value = value.child(n)
+        end
+
+        return state, value
+      end
+
+      # @return [Array<Instruction>]
+      def __match(instrumentation, state, segment_tok, strict)
+        if instrumentation.nil?
+          state.instructions.matches(segment_tok, strict, :insert)
+        else
+          instrumentation.measure(:match){ state.instructions.matches(segment_tok, strict, :insert) }
+        end
+      end
+
+      # @return [Zipper::AbstractCursor]
+      def __execute(instrumentation, op, zipper, reader, segment_tok)
+        if instrumentation.nil?
+          execute(op, zipper, reader, segment_tok)
+        else
+          successor = instrumentation.measure(:execute){ execute(op, zipper, reader, segment_tok) }
+          instrumentation.segment_use!(successor.node.zipper.node.usage)
+          successor
+        end
+      end
+
+      # @return [Either<Reader::Result>]
+      def __read_segment(instrumentation, reader)
+        if instrumentation.nil?
+          reader.read_segment
+        else
+          instrumentation.measure(:tokenize){ reader.read_segment }
+        end
+      end
+
+      # Returns a machine positioned on the first segment below `value`,
+      # which is the value of the state `state`
+      #
+      # @return [StateMachine]
+      def __first_segment(state, value)
+        until value.node.segment? or value.leaf?
+          value = value.down
+          state = state.down
+        end
+
+        # Synchronize the two parallel state and value nodes
+        unless value.eql?(state.node.zipper)
+          state = state.replace(state.node.copy(:zipper => value))
+        end
+
+        StateMachine.new(@config, state.cons)
+      end
+
+      # @return [(StateMachine, Reader::Result)]
+      def __read(reader, options)
+        limit           = options.fetch(:nondeterminism, 1)
+        instrumentation = @config.try(:instrumentation)
+        reader_e        = __read_segment(instrumentation, reader)
+
+        # This machine belongs to the caller, but the copy can be updated
+        # in place, as can each machine created while reading
+        machine  = copy(:active => @active.dup)
+
+        while reader_e.defined?
+          reader_e = reader_e.flatmap do |segment_tok, reader_|
+            machine, reader__ =
+              machine.__insert(segment_tok, false, reader_, true)
+
+            machine = yield(machine, segment_tok)
+            instrumentation.segment!(machine.active.length) unless instrumentation.nil?
+
+            if machine.active.length <= limit
+              __read_segment(instrumentation, reader__)
+            else
+              matches = machine.active.map do |m|
+                if segment_use = m.node.zipper.node.usage
+                  "SegmentUse(#{segment_use.position}, #{segment_use.id},
+                  #{segment_use.requirement.inspect}, #{segment_use.repeat_count.inspect})".join
+                else
+                  m.node.zipper.node.inspect
+                end
+              end.join(", ")
+
+              return machine, __scan_lines(
+                Reader::Result.failure("too much non-determinism: #{matches}", reader__.input, true))
+            end
+          end
+        end
+
+        return machine, __scan_lines(reader_e)
+      end
+
+      # The caller may close an IO input before the positions of the tokens
+      # that were read, or of the error, are used. When they're computed by
+      # a {Reader::LineIndex}, the newlines before them are found now.
+      #
+      # @return [Either<Reader::Result>]
+      def __scan_lines(result)
+        remainder = result.remainder if result.respond_to?(:remainder)
+        remainder.scan_lines if remainder.is_a?(Reader::AbstractInput)
+        result
+      end
     end
   end
 end
@@ -37,7 +37,7 @@ module Stupidedi
 
         # @return [InstructionTable]
         def push(instructions)
-          @__push[instructions] ||= begin
+          Cache.fetch(@__push, instructions) do
             bottom = @instructions.map do |op|
               op.copy(:pop_count => op.pop_count + 1)
             end
@@ -56,20 +56,22 @@ module Stupidedi
         end
 
         def constraints
-          @__constraints ||= begin
-            constraints = Hash.new
-
-            # Group instructions by segment identifier
-            grouped = Hash.new{|h,k| h[k] = [] }
-            @instructions.each{|op| grouped[op.segment_id] << op }
+          @__constraints || Cache.synchronize do
+            @__constraints ||= begin
+              constraints = Hash.new
+
+              # Group instructions by segment identifier
+              grouped = Hash.new{|h,k| h[k] = [] }
+              @instructions.each{|op| grouped[op.segment_id] << op }
+
+              # For each group of instructions that have the same segment
+              # id, build a constraint table that can distinguish them
+              grouped.each do |segment_id, instructions|
+                constraints[segment_id] = ConstraintTable.build(instructions)
+              end
 
-            # For each group of instructions that have the same segment
-            # id, build a constraint table that can distinguish them
-            grouped.each do |segment_id, instructions|
-              constraints[segment_id] = ConstraintTable.build(instructions)
+              constraints
             end
-
-            constraints
           end
         end
 
@@ -87,7 +89,7 @@ module Stupidedi
           if count.zero?
             self
           else
-            @__drop[count] ||= begin
+            Cache.fetch(@__drop, count) do
               # Calculate the fewest number of instructions we can drop. We
               # drop this many to construct the next InstructionTable, from
               # which we drop the remaining number of instructions.
@@ -198,7 +200,7 @@ module Stupidedi
           q.text "InstructionTable.empty"
         end
         # :nocov:
-      end.new
+      end.new.freeze
     end
 
     class << InstructionTable
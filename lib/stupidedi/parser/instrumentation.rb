@@ -0,0 +1,194 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Parser
+    #
+    # Counts the time the parser spends in each phase of reading a segment,
+    # and the number of times each phase was run:
+    #
+    # * `:tokenize` reads the next segment from the {Reader::TokenReader}
+    # * `:match` finds the {Instruction}s that match it, which includes the
+    #   {ConstraintTable} when more than one instruction names the segment
+    # * `:execute` updates the parse tree with {Generation#execute}
+    # * `:convert` builds the segment's values from its elements, including
+    #   the typed conversion done by {AbstractState.mksimple}, except for the
+    #   ISA and GS segments, which are counted in `:execute`
+    #
+    # The time in each phase doesn't include the time spent in the phases it
+    # calls, so `:execute` doesn't include `:convert`. The number and
+    # (inclusive) time of executions is also counted for each
+    # {Schema::SegmentUse}, along with the most parse trees that were built
+    # at once due to ambiguity.
+    #
+    # This is only used when it's assigned to {Config#instrumentation}. One
+    # instance can be shared by parsers running on several threads, like
+    # those of {Parallel.read}: the time of nested phases is tracked for
+    # each thread, and the counters are updated while holding a lock.
+    #
+    # @example
+    #   config = Config.hipaa.customize{|c| c.instrumentation = Parser::Instrumentation.new }
+    #   Parser.build(config).read(Reader.build(input))
+    #
+    #   config.instrumentation.to_h
+    #     #=> {:segments => 1093, :peak_nondeterminism => 1,
+    #     #    :tokenize => {:count => 1094, :time => 0.0213}, ...}
+    #
+    class Instrumentation
+      PHASES = [:tokenize, :match, :execute, :convert].freeze
+
+      # The time of the phases nested in the current {#measure}ment, and
+      # the inclusive time of the last one, for one thread
+      Frame = Struct.new(:nested, :elapsed)
+
+      class Counter
+        # @return [Integer]
+        attr_reader :count
+
+        # Total seconds
+        #
+        # @return [Float]
+        attr_reader :time
+
+        def initialize
+          @count = 0
+          @time  = 0.0
+        end
+
+        # @return [Counter]
+        def add(time)
+          @count += 1
+          @time  += time
+          self
+        end
+
+        # @return [Hash]
+        def to_h
+          { :count => @count, :time => @time }
+        end
+
+        # @return [void]
+        def pretty_print(q)
+          q.text "Counter(#{@count}, #{@time.round(6)})"
+        end
+      end
+
+      # @return [Hash<Symbol, Counter>]
+      attr_reader :phases
+
+      # @return [Hash<Schema::SegmentUse, Counter>]
+      attr_reader :segment_uses
+
+      # The number of segments read
+      #
+      # @return [Integer]
+      attr_reader :segments
+
+      # The largest number of parse trees that were built at once
+      #
+      # @return [Integer]
+      attr_reader :peak_nondeterminism
+
+      def initialize
+        @lock = Mutex.new
+        reset!
+      end
+
+      # Evaluates the block and counts its time in the given phase
+      #
+      # @return [Object] the value of the block
+      def measure(phase)
+        current = frame
+        outer, current.nested = current.nested, 0.0
+        started = clock
+
+        begin
+          yield
+        ensure
+          elapsed        = current.elapsed = clock - started
+          exclusive      = elapsed - current.nested
+          current.nested = outer + elapsed
+          @lock.synchronize{ @phases[phase].add(exclusive) }
+        end
+      end
+
+      # Counts the last {#measure}ment, including nested phases, for the
+      # segment use of the segment that was just executed
+      #
+      # @return [void]
+      def segment_use!(segment_use)
+        return if segment_use.nil?
+        elapsed = frame.elapsed
+
+        @lock.synchronize do
+          @segment_uses.fetch(segment_use){ @segment_uses[segment_use] = Counter.new }.add(elapsed)
+        end
+      end
+
+      # Counts a segment that was read while there were `active` parse trees
+      #
+      # @return [void]
+      def segment!(active)
+        @lock.synchronize do
+          @segments += 1
+          @peak_nondeterminism = active if active > @peak_nondeterminism
+        end
+      end
+
+      # @return [self]
+      def reset!
+        @lock.synchronize do
+          @phases              = Hash[PHASES.map{|p| [p, Counter.new] }]
+          @segment_uses        = {}.compare_by_identity
+          @segments            = 0
+          @peak_nondeterminism = 0
+        end
+
+        self
+      end
+
+      # Summarizes the counters, without the counters for each segment use,
+      # in a form that can be exported to a metrics system
+      #
+      # @return [Hash]
+      def to_h
+        hash = { :segments => @segments, :peak_nondeterminism => @peak_nondeterminism }
+        @phases.each{|phase, counter| hash[phase] = counter.to_h }
+        hash
+      end
+
+      # @return [void]
+      # :nocov:
+      def pretty_print(q)
+        q.text "Instrumentation"
+        q.group(2, "(", ")") do
+          q.breakable ""
+          q.text "segments: #{@segments}, peak_nondeterminism: #{@peak_nondeterminism}"
+          @phases.each do |phase, counter|
+            q.text ","
+            q.breakable
+            q.text "#{phase}: "
+            q.pp counter
+          end
+        end
+      end
+      # :nocov:
+
+    private
+
+      # The frame of the current thread, which is kept in a thread-local
+      # Hash so it goes away with the thread
+      #
+      # @return [Frame]
+      def frame
+        frames = (Thread.current[:stupidedi_instrumentation] ||= {}.compare_by_identity)
+        frames.fetch(self){ frames[self] = Frame.new(0.0, 0.0) }
+      end
+
+      # @return [Float]
+      def clock
+        Process.clock_gettime(Process::CLOCK_MONOTONIC)
+      end
+    end
+  end
+end
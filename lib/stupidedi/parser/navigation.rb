@@ -4,6 +4,9 @@ module Stupidedi
 
   module Parser
     module Navigation
+      # The fewest rightward siblings {#find} will search using an index
+      INDEX_THRESHOLD = 32
+
       #########################################################################
       # @group Querying the Current Position
 
@@ -600,6 +603,18 @@ module Stupidedi
             #    This is computed lazily below: non_leaders ||= ...
             # non_leaders = nil
 
+            # When the siblings are indexed, skip directly to the candidates
+            if parent = __indexed(value)
+              __state = __find_indexed(invalid, filter_tok, group, target, state, value, parent)
+
+              unless __state.nil?
+                matches << __state
+                matched  = true
+              end
+
+              next
+            end
+
             until state.last?
               state = state.next
               value = value.next
@@ -629,17 +644,7 @@ module Stupidedi
                     __state = __state.down
                   end
 
-                  matched =
-                    if __value.node.invalid?
-                      invalid and not __filter?(filter_tok, __value.node)
-                    else
-                      # @note op.segment_use.nil? is true when searching for ISA,
-                      # GS, and ST, because we can't know the SegmentUse until we
-                      # deconstruct the token and look up the versions numbers
-                      # in the Config
-                      ops.any?{|op| op.segment_use.nil? or op.segment_use.eql?(__value.node.usage) } \
-                        and not filter?(filter_tok, __value.node)
-                    end
+                  matched = __match?(invalid, filter_tok, ops, __value.node)
 
                   # 4. Stop on a segment
                   if matched
@@ -702,6 +707,174 @@ module Stupidedi
         end
       end
 
+      # True if `segment_val` is a match for one of the instructions `ops`
+      # and the constraints modeled in `filter_tok`
+      def __match?(invalid, filter_tok, ops, segment_val)
+        if segment_val.invalid?
+          invalid and not __filter?(filter_tok, segment_val)
+        else
+          # @note op.segment_use.nil? is true when searching for ISA,
+          # GS, and ST, because we can't know the SegmentUse until we
+          # deconstruct the token and look up the versions numbers
+          # in the Config
+          ops.any?{|op| op.segment_use.nil? or op.segment_use.eql?(segment_val.usage) } \
+            and not filter?(filter_tok, segment_val)
+        end
+      end
+
+      # Returns the parent node of `value` when its children can be searched
+      # with {Values::SegmentValGroup#segment_index}. Only a {Zipper::MemoizedCursor}
+      # is known to have a parent node whose children are its siblings; after
+      # edits, the parent node isn't rebuilt until moving {Zipper::AbstractCursor#up}.
+      #
+      # Building the index costs more than scanning a few siblings, so it's
+      # only used when there are at least {INDEX_THRESHOLD} rightward siblings.
+      #
+      # @return [Values::SegmentValGroup, nil]
+      def __indexed(value)
+        if value.is_a?(Zipper::MemoizedCursor) \
+          and value.path.siblings.length - value.path.position > INDEX_THRESHOLD
+          parent = value.up.node
+          parent if parent.respond_to?(:segment_index)
+        end
+      end
+
+      # Searches the rightward siblings of `value` in the same order as the
+      # loop in {#__find}, but uses the index of `parent` to visit only the
+      # siblings that contain a segment with the same identifier (and first
+      # element value, when possible) as `filter_tok`.
+      #
+      # Siblings that are segments are always visited, because when the state
+      # of one of them has the `target` table, each of the following siblings
+      # are searched. Other siblings can be skipped, because they'd only be
+      # searched when their state has the `target` table, and they don't have
+      # any matches. The loop would have stopped on a skipped sibling only if
+      # its table is shorter than `target`, and then so is the next one.
+      #
+      # Siblings are found by their position in the parent's children, which
+      # are the same as {Zipper::SiblingHole#siblings}, instead of copying the
+      # rightward siblings each time.
+      #
+      # @return [Zipper::AbstractCursor, nil]
+      def __find_indexed(invalid, filter_tok, ops, target, state, value, parent)
+        offset     = value.path.position + 1
+        values     = value.path.siblings
+        candidates = __candidates(parent.segment_index, invalid, filter_tok)
+        segments   = parent.segment_offsets
+        searched   = false
+
+        # Moving to a sibling of an edited cursor copies the other siblings,
+        # so the siblings are visited from a memoized cursor instead. Usually
+        # `state` is a memoized cursor whose node was replaced by {__descend},
+        # and only the zipper of that node differs, which isn't needed here;
+        # its parent still has the original siblings. Otherwise, the parent
+        # is rebuilt once, and the next search from the result won't be.
+        if state.path.is_a?(Zipper::SiblingHole)
+          first = state.parent.down
+        else
+          first = state.up.down
+        end
+
+        states = first.path.siblings
+
+        c = candidates.bsearch_index{|n| n >= offset } || candidates.length
+        s = segments.bsearch_index{|n| n >= offset } || segments.length
+
+        while n = [candidates.at(c), segments.at(s)].compact.min
+          instructions = states.at(n).instructions
+
+          if n == segments.at(s)
+            s += 1
+
+            if target.eql?(instructions)
+              # Search this and each following sibling. If there's no match,
+              # searching from any later sibling won't find one either.
+              unless searched
+                searched = true
+
+                candidates.drop(c).each do |m|
+                  segment_val = values.at(m)
+                  segment_val = segment_val.children.first until segment_val.nil? or segment_val.segment?
+
+                  if not segment_val.nil? and __match?(invalid, filter_tok, ops, segment_val)
+                    return __descend(first.next(m), value.next(m - offset + 1), [])
+                  end
+                end
+              end
+            elsif target.length > instructions.length
+              return nil
+            end
+
+            c += 1 if n == candidates.at(c)
+          else
+            c += 1
+
+            if target.eql?(instructions)
+              child   = values.at(n)
+              indexes =
+                if child.respond_to?(:segment_index) \
+                  and child.children.length >= INDEX_THRESHOLD
+                  __candidates(child.segment_index, invalid, filter_tok)
+                else
+                  child.children.each_index
+                end
+
+              indexes.each do |m|
+                segment_val = child.children.at(m)
+                segment_val = segment_val.children.first until segment_val.nil? or segment_val.segment?
+
+                if not segment_val.nil? and __match?(invalid, filter_tok, ops, segment_val)
+                  return __descend(first.next(n), value.next(n - offset + 1), [m])
+                end
+              end
+            elsif target.length > instructions.length
+              return nil
+            end
+          end
+        end
+      end
+
+      # @return [Array<Integer>]
+      def __candidates(index, invalid, filter_tok)
+        id = filter_tok.id
+        element_tok = filter_tok.element_toks.first
+
+        if not invalid and element_tok.try(:simple?) and element_tok.present? \
+          and not index.defined_at?([id])
+          index.fetch([id, element_tok.value.to_s.rstrip], [])
+        else
+          index.fetch(id, [])
+        end
+      end
+
+      # Descends from the parallel `state` and `value` cursors to the first
+      # segment of the child at each of the given indexes
+      #
+      # @return [Zipper::AbstractCursor]
+      def __descend(state, value, indexes)
+        indexes.each do |n|
+          state = state.down
+          value = value.down
+
+          unless n.zero?
+            state = state.next(n)
+            value = value.next(n)
+          end
+        end
+
+        until value.node.segment?
+          value = value.down
+          state = state.down
+        end
+
+        # Synchronize the two parallel state and value nodes
+        unless value.eql?(state.node.zipper)
+          state = state.replace(state.node.copy(:zipper => value))
+        end
+
+        state
+      end
+
       # Returns true if the constraints modeled in `filter_tok` are not
       # satisfied by the given `segment_val`, otherwise returns false.
       def filter?(filter_tok, segment_val)
@@ -0,0 +1,372 @@
+# frozen_string_literal: true
+require "etc"
+
+module Stupidedi
+  using Refinements
+
+  module Parser
+    #
+    # Parses each interchange (ISA..IEA) of a single input independently, on a
+    # pool of worker threads or forked processes. Interchanges don't share any
+    # parser state, so the results are the same as reading the entire input
+    # with {Generation#read}, and positions are relative to the entire input.
+    #
+    # On MRI, only one thread runs Ruby code at a time, so {.read} uses
+    # forked processes by default there. {.each_interchange} uses threads
+    # unless it's given `:fork => true`, because its block would otherwise
+    # run in another process; with threads, it parses on one core at a time.
+    #
+    # The input is first divided by scanning for ISA segments, using the same
+    # separator detection as {Reader::StreamReader#read_segment}, then for the
+    # IEA segment that ends each interchange. Only the segment identifiers are
+    # examined, so this is much faster than tokenizing the input.
+    #
+    # @example
+    #   machine, result = Parser::Parallel.read(config, File.open(path), :workers => 4)
+    #
+    module Parallel
+    end
+
+    class << Parallel
+      # Reads all input from `input`, a `String` or `IO`, and returns the same
+      # {StateMachine} and {Reader::Result} as {Generation#read}. Interchanges
+      # are parsed by `:workers` threads, and the parse trees are then joined
+      # together into one {Values::TransmissionVal}.
+      #
+      # When `:fork` is true, the interchanges are parsed by `:workers` forked
+      # processes instead, while this process parses the last one. A parse
+      # tree can't be sent between processes, so each worker writes it with
+      # {Snapshot.dump}, and it's loaded again here with {Snapshot.load}.
+      # This is the default on MRI when there's more than one worker.
+      #
+      # The `:tokenizer` and `:lazy_positions` options are passed to
+      # {Reader.build}, and `:nondeterminism` is passed to {Generation#read}.
+      #
+      # @return [(StateMachine, Reader::Result)]
+      def read(config, input, options = {})
+        source  = source(input)
+        chunks  = partition(Reader::Input.build(source).lazy_positions)
+        workers = workers(options)
+
+        if options.fetch(:fork){ fork?(workers) }
+          pipes = fork_workers(chunks.init, workers) do |chunk|
+            machine = complete(*Parser.build(config).read(reader(source, chunk, options), options))
+            Snapshot.dump(machine) unless machine.nil?
+          end
+
+          last     = Parser.build(config).read(reader(source, chunks.last, options), options)
+          machines = fork_results(pipes, chunks.length - 1).map do |snapshot|
+            Snapshot.load(config, snapshot) unless snapshot.nil?
+          end
+        else
+          results = thread_map(chunks, workers) do |chunk|
+            Parser.build(config).read(reader(source, chunk, options), options)
+          end
+
+          last     = results.pop
+          machines = results.map{|machine, result| complete(machine, result) }
+        end
+
+        join(config, source, chunks, machines, last, options)
+      end
+
+      # Parses each interchange from `input`, a `String` or `IO`, and yields
+      # the {StateMachine} and {Reader::Result} from reading it alone. Returns
+      # the values returned by the block, in the same order as the input.
+      #
+      # When `:fork` is true, interchanges are parsed by `:workers` forked
+      # processes, and the block runs in the worker process, so the values it
+      # returns must support `Marshal.dump`. Otherwise, `:workers` threads are
+      # used. The remaining options are the same as {#read}.
+      #
+      # @yieldparam [StateMachine] machine
+      # @yieldparam [Reader::Result] result
+      # @return [Array<Object>]
+      def each_interchange(config, input, options = {})
+        source  = source(input)
+        chunks  = partition(Reader::Input.build(source).lazy_positions)
+        workers = workers(options)
+        method  = options.fetch(:fork, false) ? :fork_map : :thread_map
+
+        send(method, chunks, workers) do |chunk|
+          yield(*Parser.build(config).read(reader(source, chunk, options), options))
+        end
+      end
+
+      # Divides `input` into chunks that each contain one interchange, along
+      # with any text that occurs before its ISA segment. Each chunk is given
+      # by the position where it starts and its length. The last chunk extends
+      # to the end of the input, so its length is nil.
+      #
+      # @return [Array<(Reader::Position, Integer)>]
+      def partition(input)
+        chunks = []
+        start  = input
+        finish = interchange_end(start)
+
+        until finish.nil? or finish.empty?
+          following = interchange_end(finish)
+
+          # When no more interchanges follow, the remaining text belongs to
+          # the last chunk, because it's skipped after reading the IEA segment
+          break if following.nil?
+
+          chunks << [mkposition(start), finish.offset - start.offset]
+          start, finish = finish, following
+        end
+
+        chunks << [mkposition(start), nil]
+      end
+
+    private
+
+      # Returns the input following the IEA segment of the first interchange
+      # in `input`, or nil if no complete interchange is found
+      #
+      # @return [Reader::AbstractInput]
+      def interchange_end(input)
+        Reader::StreamReader.new(input).read_segment.map do |_, tokenizer|
+          separators = tokenizer.separators
+          input      = tokenizer.input
+
+          until (length = input.index(separators.segment)).nil?
+            iea   = iea?(input, separators)
+            input = input.drop(length + 1)
+            return input if iea
+          end
+        end
+
+        nil
+      end
+
+      # True if the segment at the start of `input` has the segment identifier
+      # IEA, ignoring any control characters that precede it
+      def iea?(input, separators)
+        n = 0
+
+        while input.defined_at?(n) and (c = input.at(n)) != separators.segment and
+              Reader.is_control_character?(c)
+          n += 1
+        end
+
+        input.at(n) == "I" and input.at(n + 1) == "E" and input.at(n + 2) == "A" and
+          (input.at(n + 3) == separators.element or input.at(n + 3) == separators.segment)
+      end
+
+      # @return [Reader::Position]
+      def mkposition(input)
+        Reader::Position.new(input.offset, input.line, input.column, input.path)
+      end
+
+      # Inputs given as an `IO` without a path are read into memory, because
+      # each worker reads its chunks separately
+      #
+      # @return [String, IO]
+      def source(input)
+        case input
+        when String
+          input
+        when IO
+          input.respond_to?(:path) && input.path ? input : input.read
+        else
+          raise TypeError, "input must be a String or IO"
+        end
+      end
+
+      # Builds a reader for the given chunk of `source`. Chunks of an `IO` are
+      # read into memory, so workers don't share a file position.
+      #
+      # @return [Reader::StreamReader]
+      def reader(source, chunk, options)
+        position, length = chunk
+
+        string =
+          if source.is_a?(String)
+            source[position.offset, length || source.length]
+          else
+            File.binread(source.path, length, position.offset)
+          end
+
+        Reader.build(Reader::DelegatedInput.new(string, position.offset,
+          position.line, position.column), options)
+      end
+
+      # True when forked processes are used by {#read} without the `:fork`
+      # option, because threads can't parse on more than one core
+      def fork?(workers)
+        RUBY_ENGINE == "ruby" and Process.respond_to?(:fork) and workers > 1
+      end
+
+      # @return [Integer]
+      def workers(options)
+        workers = options.fetch(:workers, Etc.nprocessors)
+
+        unless workers.is_a?(Integer) and workers >= 1
+          raise ArgumentError, "workers must be a positive Integer"
+        end
+
+        workers
+      end
+
+      # Returns `machine` when it read its entire chunk and has one parse
+      #
+      # @return [StateMachine, nil]
+      def complete(machine, result)
+        machine if machine.deterministic? and result.remainder.empty?
+      end
+
+      # Joins the parse trees from each chunk, in order. The `machines` for
+      # each chunk but the last are nil when the chunk wasn't read completely
+      # with one parse; then the rest of the input is read from the end of the
+      # previous chunk, as {Generation#read} would have done. Otherwise, the
+      # machine and result from the last chunk are joined with the others.
+      #
+      # @return [(StateMachine, Reader::Result)]
+      def join(config, source, chunks, machines, last, options)
+        machines.each_with_index do |machine, n|
+          next unless machine.nil?
+
+          machine   = n.zero? ? Parser.build(config) : stitch(machines.take(n - 1), machines.at(n - 1))
+          position, = chunks.at(n)
+          return machine.read(reader(source, [position, nil], options), options)
+        end
+
+        machine, result = last
+        return stitch(machines, machine), result
+      end
+
+      # Returns a copy of `machine`, with the interchanges from each of the
+      # deterministic `machines` inserted before its own
+      #
+      # @return [StateMachine]
+      def stitch(machines, machine)
+        return machine if machines.empty?
+
+        values = []
+        states = []
+
+        machines.each do |m|
+          values.concat(m.active.head.node.zipper.root.node.children)
+          states.concat(m.active.head.root.node.children)
+        end
+
+        active = machine.active.map do |state|
+          value, vpath = path(state.node.zipper)
+          state, spath = path(state)
+
+          value = Zipper::Tree.build(value.node.copy(
+            :children => values + value.node.children))
+
+          state = Zipper::Tree.build(state.node.copy(
+            :children => states + state.node.children,
+            :zipper   => value))
+
+          vpath[0] += values.length
+          spath[0] += states.length
+
+          value = value.descendant(*vpath)
+          state = state.descendant(*spath)
+          state.replace(state.node.copy(:zipper => value))
+        end
+
+        machine.copy(:active => active)
+      end
+
+      # Returns the root cursor and the index of each node between the root
+      # and `zipper`
+      #
+      # @return [(Zipper::AbstractCursor, Array<Integer>)]
+      def path(zipper)
+        indexes = []
+
+        until zipper.root?
+          indexes.unshift(zipper.path.left.length)
+          zipper = zipper.up
+        end
+
+        return zipper, indexes
+      end
+
+      # @return [Array]
+      def thread_map(chunks, workers)
+        queue   = Queue.new
+        results = Array.new(chunks.length)
+
+        chunks.each_with_index{|chunk, n| queue << [chunk, n] }
+        queue.close
+
+        threads = [workers, chunks.length].min.times.map do
+          Thread.new do
+            while item = queue.pop
+              chunk, n   = item
+              results[n] = yield(chunk)
+            end
+          end
+        end
+
+        threads.each(&:join)
+        results
+      end
+
+      # @return [Array]
+      def fork_map(chunks, workers, &block)
+        fork_results(fork_workers(chunks, workers, &block), chunks.length)
+      end
+
+      # Forks up to `workers` processes, which each yield some of the chunks
+      # and write the results to a pipe
+      #
+      # @return [Array<(Integer, IO)>]
+      def fork_workers(chunks, workers)
+        slices = chunks.each_with_index.group_by{|_, n| n % workers }.values
+
+        slices.map do |slice|
+          rd, wr = IO.pipe
+
+          pid = Process.fork do
+            rd.close
+
+            begin
+              slice.each{|chunk, n| Marshal.dump([n, yield(chunk)], wr) }
+            rescue Exception => e
+              Marshal.dump([:error, "#{e.class}: #{e.message}"], wr)
+            end
+
+            wr.close
+            exit!(0)
+          end
+
+          wr.close
+          [pid, rd]
+        end
+      end
+
+      # Reads the results written by each process from {#fork_workers}, and
+      # waits for the processes to finish
+      #
+      # @return [Array]
+      def fork_results(pipes, length)
+        results = Array.new(length)
+        error   = nil
+
+        pipes.each do |pid, rd|
+          until rd.eof?
+            n, value = Marshal.load(rd)
+
+            if n == :error
+              error ||= value
+            else
+              results[n] = value
+            end
+          end
+
+          rd.close
+          Process.wait(pid)
+        end
+
+        raise error unless error.nil?
+        results
+      end
+    end
+  end
+end
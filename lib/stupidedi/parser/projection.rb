@@ -0,0 +1,71 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Parser
+    #
+    # The tables, loops, and segments of a transaction set whose values
+    # should be built while parsing. Each one is named by its identifier from
+    # the {Schema::TransactionSetDef}: a table like "1 - Header", a loop like
+    # "2100 CLAIM PAYMENT INFORMATION" or just the first word of it, "2100",
+    # or a segment like "CLP". A segment is in the projection when its own
+    # identifier is named, or when any of the tables and loops that contain
+    # it are named.
+    #
+    # The parser still reads every segment, so the grammar is tracked the
+    # same way, but segments outside the projection are stored as a
+    # {Values::RawSegmentVal} instead of being converted.
+    #
+    # @see Config#projection
+    #
+    class Projection
+      # @return [Array<String>]
+      attr_reader :ids
+
+      def initialize(ids)
+        @ids   = ids.map(&:to_s).freeze
+        @names = Set.new(@ids)
+        @cache = {}.compare_by_identity
+      end
+
+      # True if values should be built for the segment `segment_use`
+      #
+      # @param segment_use [Schema::SegmentUse]
+      def include?(segment_use)
+        # Once frozen, see Stupidedi.make_shareable
+        return projected?(segment_use) if @cache.frozen?
+
+        @cache.fetch(segment_use) do
+          @cache[segment_use] = projected?(segment_use)
+        end
+      end
+
+      # @return [void]
+      # :nocov:
+      def pretty_print(q)
+        q.text "Projection"
+        q.group(2, "(", ")") do
+          q.breakable ""
+          q.text @ids.join(", ")
+        end
+      end
+      # :nocov:
+
+    private
+
+      # @return [Boolean]
+      def projected?(segment_use)
+        return true if @names.include?(segment_use.id.to_s)
+
+        parent = segment_use.parent
+        while parent.is_a?(Schema::LoopDef) or parent.is_a?(Schema::TableDef)
+          return true if @names.include?(parent.id)
+          return true if @names.include?(parent.id.split(" ", 2).first)
+          parent = parent.parent
+        end
+
+        false
+      end
+    end
+  end
+end
@@ -0,0 +1,514 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Parser
+    #
+    # Saves a parse tree so it can be loaded again without reading its input.
+    # Each segment is recorded with the text of its elements (the original
+    # text of a {Values::LazyElementVal}, which is the same as `#to_x12`
+    # otherwise), the byte offsets of its tokens, and the index of the
+    # {Instruction} that placed it in the table of the state that precedes
+    # it. That index resolves the {Schema::SegmentUse} against the schema
+    # again, and each {Schema::ElementUse} follows from the segment's
+    # definition, so {.load} executes the instructions directly: the input
+    # isn't tokenized and no instructions are matched against the segments.
+    #
+    # The tree of states is built again the same way {StateMachine#read}
+    # builds it, so the machine that's returned can be navigated, written,
+    # edited, and critiqued like the original. Each segment is stored as a
+    # {Values::RawSegmentVal}, whose element tokens and values are built
+    # from the record the first time they're used, which makes loading about
+    # five times faster than reading. When {Config#lazy_elements} is enabled,
+    # the element text isn't converted until it's used. Line and column
+    # numbers are computed from offsets with a {Reader::LineIndex}, which is
+    # built from the newlines recorded in the snapshot.
+    #
+    # The snapshot is a header with the format and version, followed by
+    # arrays of strings, symbols, and integers written by {Snapshot::Codec}
+    # rather than `Marshal`, so loading it can't create objects of any other
+    # class. It can only be loaded by the same version of the format, and it
+    # must be loaded with a {Config} that has the same definitions as the
+    # config that parsed the input.
+    #
+    # @example
+    #   machine, = Parser.build(config).read(Reader.build(input))
+    #   File.open("input.snapshot", "wb"){|io| Parser::Snapshot.dump(machine, io) }
+    #
+    #   machine = File.open("input.snapshot", "rb"){|io| Parser::Snapshot.load(config, io) }
+    #
+    class Snapshot
+      # Identifies the format, and the version that's written
+      FORMAT  = "stupidedi.snapshot"
+      VERSION = 1
+
+      # Marks a repeated element, whose occurrences follow it in the same array
+      REPEATED = :repeated
+
+      #
+      # A segment read from a snapshot record, whose element tokens are built
+      # from the record the first time they're used. The parser stores it in
+      # a {Values::RawSegmentVal}, so its elements aren't converted until then
+      # either.
+      #
+      # @private
+      #
+      class SegmentTok < Reader::SegmentTok
+        def initialize(id, elements, offsets, position, lines, unknown)
+          @id, @elements, @offsets, @position, @lines, @unknown =
+            id, elements, offsets, position, lines, unknown
+        end
+
+        # @return [Array<Reader::SimpleElementTok, Reader::CompositeElementTok, Reader::RepeatedElementTok>]
+        def element_toks
+          @element_toks ||= begin
+            offsets = @offsets.dup
+            @elements.map{|e| token(e, offsets) }
+          end
+        end
+
+      private
+
+        # @return [Reader::SimpleElementTok, Reader::CompositeElementTok, Reader::RepeatedElementTok]
+        def token(entry, offsets)
+          if entry.is_a?(Array)
+            if entry.present? and entry.head == Snapshot::REPEATED
+              toks = entry.tail.map{|e| token(e, offsets) }
+              Reader::RepeatedElementTok.build(toks, toks.empty? ? @position : toks.last.position)
+            else
+              toks = entry.map{|c| Reader::ComponentElementTok.build(c, at(offsets.shift), nil) }
+              Reader::CompositeElementTok.build(toks, toks.empty? ? @position : toks.head.position, nil)
+            end
+          else
+            Reader::SimpleElementTok.build(entry, at(offsets.shift), nil)
+          end
+        end
+
+        # @return [Reader::Position]
+        def at(offset)
+          offset.nil? ? @unknown : Reader::LazyPosition.new(offset, @lines)
+        end
+      end
+
+      #
+      # Writes and reads nested arrays of `nil`, `Integer`, `String`, `Symbol`,
+      # and `Pathname` values. Each value is written as a tag and its length
+      # (or value) in a list of BER-compressed integers, which is followed by
+      # the bytes of every string. Unlike `Marshal`, reading can't create an
+      # object of any other class, and the header is checked first.
+      #
+      # @private
+      #
+      class Codec
+        NIL, INTEGER, NEGATIVE, STRING, SYMBOL, PATHNAME, ARRAY = 0, 1, 2, 3, 4, 5, 6
+
+        # @return [String]
+        def self.dump(value)
+          codec = new([], String.new, [])
+          codec.write(value)
+          codec.to_s
+        end
+
+        # @return [Object]
+        def self.load(input)
+          header = Snapshot::FORMAT.bytesize + 1
+          format = input.byteslice(0, header)
+
+          unless format == Snapshot::FORMAT + "\0" and input.bytesize >= header + 12
+            raise ArgumentError, "input is not a snapshot"
+          end
+
+          version, names, ints = input.byteslice(header, 12).unpack("NNN")
+
+          unless version == Snapshot::VERSION
+            raise ArgumentError, "input is not a version #{Snapshot::VERSION} snapshot"
+          end
+
+          start = header + 12 + names + ints
+          raise IndexError if input.bytesize < start
+
+          encodings = input.byteslice(header + 12, names).split("\0").map{|n| ::Encoding.find(n) }
+          ints      = input.byteslice(header + 12 + names, ints).unpack("w*")
+
+          new(ints, input.byteslice(start, input.bytesize - start), encodings).read
+        rescue IndexError
+          raise ArgumentError, "snapshot is truncated"
+        end
+
+        def initialize(ints, bytes, encodings)
+          @ints, @bytes, @encodings, @i, @pos =
+            ints, bytes.force_encoding(::Encoding::BINARY), encodings, -1, 0
+        end
+
+        # @return [void]
+        def write(value)
+          case value
+          when nil
+            @ints << NIL
+          when Integer
+            value < 0 ? @ints.push(NEGATIVE, -value) : @ints.push(INTEGER, value)
+          when String
+            @ints.push(STRING, value.bytesize, encoding(value))
+            @bytes << (value.ascii_only? ? value : value.b)
+          when Symbol
+            @ints.push(SYMBOL, value.to_s.bytesize)
+            @bytes << value.to_s.b
+          when Array
+            @ints.push(ARRAY, value.length)
+            value.each{|x| write(x) }
+          else
+            raise ArgumentError, "can't write #{value.class}" unless defined?(::Pathname) and ::Pathname === value
+            @ints << PATHNAME
+            write(value.to_s)
+          end
+        end
+
+        # @return [Object]
+        def read
+          case @ints.fetch(@i += 1)
+          when NIL      then nil
+          when INTEGER  then @ints.fetch(@i += 1)
+          when NEGATIVE then -@ints.fetch(@i += 1)
+          when STRING   then bytes.force_encoding(@encodings.fetch(@ints.fetch(@i += 1)))
+          when SYMBOL   then bytes.to_sym
+          when ARRAY    then Array.new(length){ read }
+          when PATHNAME
+            require "pathname"
+            path = read
+            raise ArgumentError, "snapshot is invalid" unless path.is_a?(String)
+            Pathname.new(path)
+          else
+            raise ArgumentError, "snapshot is invalid"
+          end
+        end
+
+        # @return [String]
+        def to_s
+          names = @encodings.map{|e| e.name + "\0" }.join
+          ints  = @ints.pack("w*")
+
+          String.new << Snapshot::FORMAT << "\0" <<
+            [Snapshot::VERSION, names.bytesize, ints.bytesize].pack("NNN") << names << ints << @bytes
+        end
+
+      private
+
+        # @return [Integer]
+        def encoding(string)
+          @encodings.index(string.encoding) || (@encodings << string.encoding).length - 1
+        end
+
+        # The next string in the buffer, whose length is the next integer
+        #
+        # @return [String]
+        def bytes
+          length = @ints.fetch(@i += 1)
+          raise IndexError if @pos + length > @bytes.bytesize
+
+          string = @bytes.byteslice(@pos, length)
+          @pos  += length
+          string
+        end
+
+        # The length of the next array, which can't have more elements than
+        # there are integers left to read
+        #
+        # @return [Integer]
+        def length
+          length = @ints.fetch(@i += 1)
+          raise IndexError if length > @ints.length - @i
+          length
+        end
+      end
+    end
+
+    class << Snapshot
+      # Writes the parse tree of `machine`, which must be deterministic, to
+      # `output` or to a new `String`
+      #
+      # @param [IO, nil] output
+      # @return [String, IO]
+      def dump(machine, output = nil)
+        unless machine.deterministic?
+          raise ArgumentError, "machine is not deterministic"
+        end
+
+        state = machine.active.head
+        value = state.node.zipper
+
+        state = state.up until state.root?
+        value = value.up until value.root?
+
+        records = []
+        lines   = {}
+        records(state.node, value.node, state.node.instructions, records, lines)
+
+        data = Snapshot::Codec.dump([path(value.node), newlines(lines), records])
+        output.nil? ? data : output.tap{|io| io.write(data) }
+      end
+
+      # Builds the parse tree that was written by {.dump} from a `String` or
+      # `IO`, and returns a {StateMachine} positioned on its last segment.
+      # Like {StateMachine#read}, the trees are appended to with
+      # {Zipper::BuilderCursor}s unless another kind of `zipper` is given.
+      #
+      # @return [StateMachine]
+      def load(config, input, zipper = Zipper::Builder)
+        input = input.read if input.respond_to?(:read)
+        path, newlines, records = Snapshot::Codec.load(input)
+
+        lines   = line_index(newlines, path)
+        unknown = Reader::Position.new(nil, nil, nil, path)
+        machine = StateMachine.build(config, zipper)
+        state   = machine.active.head
+        reader  = Reader::TokenReader.new("", Reader::Separators.empty)
+
+        records.each do |index, id, offsets, elements, separators|
+          offsets = unpack(offsets)
+
+          unless separators.nil?
+            reader = reader.copy(:separators => Reader::Separators.new(*separators))
+          end
+
+          position = position(offsets.shift, lines, unknown)
+          segment  = Snapshot::SegmentTok.new(id, elements, offsets, position, lines, unknown)
+
+          if index < 0
+            machine, reader = StateMachine.new(config, state.cons).insert(segment, false, reader)
+            state = machine.active.head
+          else
+            op = state.node.instructions.instructions.at(index)
+
+            unless op and op.segment_id == id
+              raise ArgumentError, "snapshot doesn't match the definitions in config"
+            end
+
+            successor = machine.execute(op, state, reader, segment)
+            reader    = machine.update_reader(op, reader, successor)
+            state     = successor
+          end
+        end
+
+        StateMachine.new(config, state.cons)
+      end
+
+      # The text the element value was read from, without converting it when
+      # it's a {Values::LazyElementVal}
+      #
+      # @private
+      # @return [String]
+      def text(value)
+        if Values::LazyElementVal === value
+          value.text
+        elsif value.invalid?
+          value.value.to_s
+        else
+          value.to_x12(false)
+        end
+      end
+
+    private
+
+      # Appends a record for each segment below `value`, and returns the
+      # instruction table that follows the last one. Each state has the same
+      # children as its value, and when the value is a segment, its state
+      # holds the instructions that follow the segment.
+      #
+      # @return [InstructionTable]
+      def records(state, value, table, records, lines)
+        if value.segment?
+          records << record(value, table, state, lines)
+          state.instructions
+        else
+          value.children.each_with_index do |child, n|
+            table = records(state.children.at(n), child, table, records, lines)
+          end
+
+          table
+        end
+      end
+
+      # @return [Array]
+      def record(segment, table, state, lines)
+        offsets = [offset(segment.position, lines)]
+
+        if segment.respond_to?(:segment_tok)
+          # An InvalidSegmentVal or RawSegmentVal keeps the tokens it was
+          # read from, which are recorded as they are
+          elements = segment.segment_tok.element_toks.map{|e| tokens(e, offsets, lines) }
+        else
+          elements = segment.children.map{|e| [element(e, offsets_ = [], lines), offsets_] }
+
+          elements.pop while elements.present? and implied?(elements, offsets.head)
+          elements = elements.map{|e, offsets_| offsets.concat(offsets_); e }
+        end
+
+        record = [index(segment, table), segment.id, pack(offsets), elements]
+        record << separators(state.separators) if segment.id == :ISA
+        record
+      end
+
+      # The index of the instruction in `table` that the parser would have
+      # chosen to add `segment`, or -1 when the instructions have to be
+      # matched again
+      #
+      # @return [Integer]
+      def index(segment, table)
+        return -1 if segment.invalid?
+
+        usage   = segment.usage
+        matches = []
+
+        table.instructions.each_with_index do |op, n|
+          if op.segment_id == segment.id and (op.segment_use.nil? or op.segment_use.equal?(usage))
+            matches << n
+          end
+        end
+
+        return matches.head if matches.length == 1
+
+        # When the same segment use can be placed at different levels of the
+        # tree, the parser chooses the instruction that pops the fewest states
+        constraint = table.constraints[segment.id]
+        return -1 unless ConstraintTable::Shallowest === constraint
+
+        chosen = constraint.matches(nil, false, :insert)
+        return -1 unless chosen.length == 1
+
+        matches.find(-> { -1 }){|n| table.instructions.at(n).equal?(chosen.head) }
+      end
+
+      # @return [String, Array]
+      def element(value, offsets, lines)
+        if value.repeated?
+          value.children.map{|e| element(e, offsets, lines) }.unshift(Snapshot::REPEATED)
+        elsif value.composite?
+          components = value.children.map{|c| [text(c), offset(c.position, lines)] }
+          # The first component is kept so an empty composite keeps its offset
+          components.pop while components.length > 1 and components.last.head.empty?
+          components.map{|c, o| offsets << o; c }
+        else
+          offsets << offset(value.position, lines)
+          text(value)
+        end
+      end
+
+      # @return [String, Array]
+      def tokens(token, offsets, lines)
+        if token.repeated?
+          token.element_toks.map{|e| tokens(e, offsets, lines) }.unshift(Snapshot::REPEATED)
+        elsif token.composite?
+          token.component_toks.map{|c| offsets << offset(c.position, lines); c.value }
+        else
+          offsets << offset(token.position, lines)
+          token.value
+        end
+      end
+
+
+      # True if the last element can be left out of the record, because it's
+      # empty and the parser gives a missing element the position of the
+      # token before it, so it's read the same way when it's left out
+      def implied?(elements, start)
+        entry, offsets = elements.last
+        return false unless entry.empty? or entry == [""] or entry == [Snapshot::REPEATED]
+
+        before = elements.init.reverse_each.map(&:last).find(&:present?)
+        before = before.nil? ? start : before.last
+        offsets.all?{|o| o == before }
+      end
+
+      # Stores the offsets as the segment's offset followed by the distance
+      # of each token from it, BER-compressed like {Values::PackedTransactionSetVal},
+      # unless some positions don't have an offset
+      #
+      # @return [String, Array<Integer, nil>]
+      def pack(offsets)
+        start = offsets.head
+        return offsets if start.nil? or offsets.any?{|o| o.nil? or o < start }
+
+        offsets.map{|o| o - start }.tap{|ds| ds[0] = start }.pack("w*")
+      end
+
+      # @return [Array<Integer, nil>]
+      def unpack(offsets)
+        return offsets unless offsets.is_a?(String)
+
+        offsets = offsets.unpack("w*")
+        start   = offsets.head
+
+        offsets.map!{|o| o + start }
+        offsets[0] = start
+        offsets
+      end
+
+      # @return [Reader::Position]
+      def position(offset, lines, unknown)
+        offset.nil? ? unknown : Reader::LazyPosition.new(offset, lines)
+      end
+
+      # Records the newline that begins the line of `position`, which is
+      # `column` bytes before it, and returns its offset. The ISA16 element
+      # is positioned at the input it was read from, rather than a position.
+      #
+      # @return [Integer, nil]
+      def offset(position, lines)
+        position = position.position if position.is_a?(Reader::AbstractInput)
+        return nil unless position.is_a?(Reader::Position)
+
+        offset = position.offset
+        return nil if offset.nil?
+
+        line, column = position.line, position.column
+        lines[line] ||= offset - column unless line.nil? or column.nil?
+        offset
+      end
+
+      # Converts the offset of the newline before each line into an array
+      # with the offsets of the first line's start and of each newline. For
+      # lines that didn't have any tokens, like blank lines, the newlines are
+      # assumed to come just before those of the next line.
+      #
+      # @return [Array<Integer>]
+      def newlines(lines)
+        return [] if lines.empty?
+
+        first = lines.keys.min
+        start = lines[first]
+        last  = lines.keys.max
+
+        newlines = []
+        last.downto(first + 1) do |line|
+          newline = lines[line] || [newlines.last - 1, start + 1].max
+          newlines << newline
+        end
+
+        [first, start, *newlines.reverse]
+      end
+
+      # @return [Reader::LineIndex]
+      def line_index(newlines, path)
+        first, start, *newlines = newlines
+
+        # An input with no positions, eg one that was built by BuilderDsl
+        first, start = 1, -1 if first.nil?
+
+        Reader::LineIndex.new(start + 1, first, 1, path) do |offset|
+          newlines.bsearch{|n| n >= offset }
+        end
+      end
+
+      # @return [Array<String>]
+      def separators(separators)
+        [separators.component, separators.repetition, separators.element, separators.segment]
+      end
+
+      # @return [String, Pathname, nil]
+      def path(transmission)
+        segment = transmission.children.head
+        segment = segment.children.head until segment.nil? or segment.segment?
+        segment.try{|s| s.position.try(:path) if s.position.is_a?(Reader::Position) }
+      end
+    end
+  end
+end
@@ -50,6 +50,13 @@ module Stupidedi
       # @group Constructors
       #########################################################################
 
+      # The `zipper` argument selects how the parse tree is built. Passing
+      # {Zipper::Builder} appends each segment in constant time, which is
+      # faster for transaction sets with many loops, and builds the same tree.
+      # {Generation#read} and {Generation#each_transaction_set} always append
+      # this way while the input has only one parse, so this only matters
+      # for {Generation#insert}, which is used by {BuilderDsl}.
+      #
       # @return [StateMachine]
       def build(config, zipper = Zipper::Tree)
         StateMachine.new(config, InitialState.start(zipper).cons)
@@ -52,8 +52,29 @@ module Stupidedi
       # @group SegmentVal Construction
       #########################################################################
 
+      # Segments outside the {Config#projection}, and segments loaded by
+      # {Snapshot.load}, aren't converted until their elements are used
+      #
+      # @return [Values::SegmentVal]
+      def mksegment(segment_tok, segment_use, config = nil)
+        projection = config.try(:projection)
+        lazy       = config.try(:lazy_elements)
+
+        if Snapshot::SegmentTok === segment_tok or not (projection.nil? or projection.include?(segment_use))
+          return Values::RawSegmentVal.new(segment_tok, segment_use, lazy)
+        end
+
+        instrumentation = config.try(:instrumentation)
+
+        if instrumentation.nil?
+          __mksegment(segment_tok, segment_use, lazy)
+        else
+          instrumentation.measure(:convert){ __mksegment(segment_tok, segment_use, lazy) }
+        end
+      end
+
       # @return [Values::SegmentVal]
-      def mksegment(segment_tok, segment_use)
+      def __mksegment(segment_tok, segment_use, lazy)
         segment_def  = segment_use.definition
         element_uses = segment_def.element_uses
         element_toks = segment_tok.element_toks
@@ -73,7 +94,7 @@ module Stupidedi
                 element_use.empty(position)
               end
             else
-              mkelement("#{segment_def.id}#{element_idx}", element_use, element_tok)
+              mkelement("#{segment_def.id}#{element_idx}", element_use, element_tok, lazy)
             end
         end
 
@@ -81,28 +102,28 @@ module Stupidedi
       end
 
       # @return [Values::SimpleElementVal, Values::CompositeElementVal, Values::RepeatedElementVal]
-      def mkelement(designator, element_use, element_tok)
+      def mkelement(designator, element_use, element_tok, lazy = false)
         if element_use.simple?
           if element_use.repeatable?
             element_toks = element_tok.element_toks
             element_vals = element_toks.map do |element_tok1|
-              mksimple(designator, element_use, element_tok1)
+              mksimple(designator, element_use, element_tok1, lazy)
             end
 
             mkrepeated(designator, element_use, element_vals)
           else
-            mksimple(designator, element_use, element_tok)
+            mksimple(designator, element_use, element_tok, lazy)
           end
         else
           if element_use.repeatable?
             element_toks = element_tok.element_toks
             element_vals = element_toks.map do |element_tok1|
-              mkcomposite(designator, element_use, element_tok1)
+              mkcomposite(designator, element_use, element_tok1, lazy)
             end
 
             mkrepeated(designator, element_use, element_vals)
           else
-            mkcomposite(designator, element_use, element_tok)
+            mkcomposite(designator, element_use, element_tok, lazy)
           end
         end
       end
@@ -114,7 +135,7 @@ module Stupidedi
       end
 
       # @return [Values::CompositeElementVal]
-      def mkcomposite(designator, composite_use, composite_tok)
+      def mkcomposite(designator, composite_use, composite_tok, lazy = false)
         composite_def  = composite_use.definition
         component_uses = composite_def.component_uses
         component_toks = composite_tok.component_toks
@@ -130,7 +151,7 @@ module Stupidedi
             if component_tok.nil?
               component_use.empty(position)
             else
-              mksimple("#{designator}-#{component_idx}", component_use, component_tok)
+              mksimple("#{designator}-#{component_idx}", component_use, component_tok, lazy)
             end
         end
 
@@ -138,7 +159,7 @@ module Stupidedi
       end
 
       # @return [Values::SimpleElementVal]
-      def mksimple(designator, element_use, element_tok)
+      def mksimple(designator, element_use, element_tok, lazy = false)
         # We don't validate that element_tok is simple because the TokenReader
         # will always produce a SimpleElementTok given a SimpleElementUse from
         # the SegmentDef. On the other hand, the BuilderDsl API will throw an
@@ -167,6 +188,8 @@ module Stupidedi
           end
         elsif element_tok.value == :blank
           element_use.empty(element_tok.position)
+        elsif lazy and element_tok.value.is_a?(String)
+          Values::LazyElementVal.new(element_tok.value, element_use, element_tok.position)
         else
           element_use.value(element_tok.value, element_tok.position)
         end
@@ -86,8 +86,7 @@ module Stupidedi
 
       # @return [Array<Instruction>]
       def instructions(functional_group_def)
-        @__instructions ||= Hash.new
-        @__instructions[functional_group_def] ||= begin
+        Cache.fetch(Cache.table(self), functional_group_def) do
           is = sequence(functional_group_def.header_segment_uses.tail)
           is << Instruction.new(:ST, nil, 0, is.length, TransactionSetState)
           is.concat(sequence(functional_group_def.trailer_segment_uses, is.length))
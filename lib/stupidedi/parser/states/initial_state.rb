@@ -42,10 +42,7 @@ module Stupidedi
           Reader::Separators.empty,
           Reader::SegmentDict.empty,
 
-          InstructionTable.build(
-            # We initially accept only a single segment. When reading the "ISA"
-            # segment, we push a new InterchangeState.
-            Instruction.new(:ISA, nil, 0, 0, TransmissionState).cons),
+          instructions,
 
           # Create a new parse tree with a Transmission as the root, and descend
           # to the placeholder where the first child node will be placed.
@@ -57,6 +54,21 @@ module Stupidedi
       def start(zipper)
         zipper.build(build(zipper))
       end
+
+    private
+
+      # Every parser starts from the same {InstructionTable}, so the tables
+      # pushed onto it, and their {ConstraintTable}s, are shared by each parser
+      #
+      # @return [InstructionTable]
+      def instructions
+        Cache.fetch(Cache.table(self), :instructions) do
+          InstructionTable.build(
+            # We initially accept only a single segment. When reading the "ISA"
+            # segment, we push a new InterchangeState.
+            Instruction.new(:ISA, nil, 0, 0, TransmissionState).cons)
+        end
+      end
     end
   end
 end
@@ -76,8 +76,7 @@ module Stupidedi
 
       # @return [Array<Instruction>]
       def instructions(interchange_def)
-        @__instructions ||= Hash.new
-        @__instructions[interchange_def] ||= begin
+        Cache.fetch(Cache.table(self), interchange_def) do
           is = if interchange_def.header_segment_uses.head.repeatable?
                  sequence(interchange_def.header_segment_uses)
                else
@@ -43,7 +43,7 @@ module Stupidedi
       def push(zipper, parent, segment_tok, segment_use, config)
         loop_def    = segment_use.parent
         loop_val    = loop_def.empty
-        segment_val = mksegment(segment_tok, segment_use)
+        segment_val = mksegment(segment_tok, segment_use, config)
 
         zipper.append_child new(
           parent.separators,
@@ -60,8 +60,7 @@ module Stupidedi
 
       # @return [Array<Instruction>]
       def instructions(loop_def)
-        @__instructions ||= Hash.new
-        @__instructions[loop_def] ||= begin
+        Cache.fetch(Cache.table(self), loop_def) do
           # When first segment is repeatable, then `successors` should include
           # an {Instruction} for it; but when it's non-repeatable, there should
           # be no successor instruction for that segment.
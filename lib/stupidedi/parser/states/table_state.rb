@@ -45,9 +45,9 @@ module Stupidedi
         when Schema::TableDef
           table_def   = segment_use.parent
           table_val   = table_def.empty
-          segment_val = mksegment(segment_tok, segment_use)
+          segment_val = mksegment(segment_tok, segment_use, config)
 
-          itable = InstructionTable.build(instructions(table_def))
+          itable = instructions(table_def)
           itable = itable.drop(itable.at(segment_use).drop_count)
 
           zipper.append_child new(
@@ -61,7 +61,7 @@ module Stupidedi
           table_def = segment_use.parent.parent
           table_val = table_def.empty
 
-          itable = InstructionTable.build(instructions(table_def))
+          itable = instructions(table_def)
           itable = itable.drop(itable.at(segment_use).drop_count)
 
           zipper = zipper.append_child new(
@@ -80,13 +80,16 @@ module Stupidedi
 
     private
 
-      # @return [Array<Instruction]
+      # The table is shared by each push, so the tables that {InstructionTable#drop}
+      # derives from it, and their {Instruction} lists, are also shared
+      #
+      # @return [InstructionTable]
       def instructions(table_def)
-        @__instructions ||= Hash.new
-        @__instructions[table_def] ||= begin
+        Cache.fetch(Cache.table(self), table_def) do
           is = sequence(table_def.header_segment_uses)
           is.concat(lsequence(table_def.loop_defs, is.length))
           is.concat(sequence(table_def.trailer_segment_uses, is.length))
+          InstructionTable.build(is)
         end
       end
     end
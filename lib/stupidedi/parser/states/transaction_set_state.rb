@@ -101,8 +101,7 @@ module Stupidedi
 
       # @return [Array<Instruction>]
       def instructions(transaction_set_def)
-        @__instructions ||= Hash.new
-        @__instructions[transaction_set_def] ||= begin
+        Cache.fetch(Cache.table(self), transaction_set_def) do
           # When first segment is repeatable, then `successors` should include
           # an {Instruction} for it; but when it's non-repeatable, there should
           # be no successor instruction for that segment.
@@ -44,8 +44,7 @@ module Stupidedi
         zipper = zipper.append_child new(
           parent.separators,
           parent.segment_dict,
-          parent.instructions.push([
-            Instruction.new(:ISA, nil, 0, 0, InterchangeState)]),
+          parent.instructions.push(instructions),
           parent.zipper.dangle.last,
           [])
 
@@ -54,6 +53,15 @@ module Stupidedi
 
       # @endgroup
       #########################################################################
+
+    private
+
+      # @return [Array<Instruction>]
+      def instructions
+        Cache.fetch(Cache.table(self), :instructions) do
+          [Instruction.new(:ISA, nil, 0, 0, InterchangeState)]
+        end
+      end
     end
   end
 end
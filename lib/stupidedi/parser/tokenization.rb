@@ -11,14 +11,14 @@ module Stupidedi
       #
       # @return [void]
       def repeated(*elements)
-        [:repeated, elements, Reader::Position.caller(2)]
+        [:repeated, elements, (Reader::Position.caller(2) if positions?)]
       end
 
       # Generates a composite element
       #
       # @return [void]
       def composite(*components)
-        [:composite, components, Reader::Position.caller(2)]
+        [:composite, components, (Reader::Position.caller(2) if positions?)]
       end
 
       #########################################################################
@@ -28,7 +28,7 @@ module Stupidedi
       #
       # @return [void]
       def blank
-        [:blank, nil, Reader::Position.caller(2)]
+        [:blank, nil, (Reader::Position.caller(2) if positions?)]
       end
 
       # Generates a blank element and asserts that the element's usage
@@ -38,7 +38,7 @@ module Stupidedi
       #
       # @return [void]
       def not_used
-        [:not_used, nil, Reader::Position.caller(2)]
+        [:not_used, nil, (Reader::Position.caller(2) if positions?)]
       end
 
       # Generates the only possible value an element may have, which may
@@ -50,7 +50,7 @@ module Stupidedi
       #
       # @return [void]
       def default
-        [:default, nil, Reader::Position.caller(2)]
+        [:default, nil, (Reader::Position.caller(2) if positions?)]
       end
 
       # @endgroup
@@ -58,6 +58,12 @@ module Stupidedi
 
     private
 
+      # When false, the element constructors and placeholders don't capture
+      # the caller's position, which requires a backtrace
+      def positions?
+        true
+      end
+
       # @return [Reader::SegmentTok]
       def mksegment_tok(segment_dict, id, elements, position)
         id = id.to_sym
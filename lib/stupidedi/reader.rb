@@ -8,10 +8,11 @@ module Stupidedi
     autoload :Success,      "stupidedi/reader/result"
     autoload :Failure,      "stupidedi/reader/result"
 
-    autoload :StreamReader, "stupidedi/reader/stream_reader"
-    autoload :TokenReader,  "stupidedi/reader/token_reader"
-    autoload :Separators,   "stupidedi/reader/separators"
-    autoload :SegmentDict,  "stupidedi/reader/segment_dict"
+    autoload :StreamReader,   "stupidedi/reader/stream_reader"
+    autoload :TokenReader,    "stupidedi/reader/token_reader"
+    autoload :SegmentScanner, "stupidedi/reader/segment_scanner"
+    autoload :Separators,     "stupidedi/reader/separators"
+    autoload :SegmentDict,    "stupidedi/reader/segment_dict"
 
     autoload :ComponentElementTok,  "stupidedi/reader/tokens/component_element_tok"
     autoload :CompositeElementTok,  "stupidedi/reader/tokens/composite_element_tok"
@@ -21,7 +22,10 @@ module Stupidedi
 
     autoload :Input,          "stupidedi/reader/input"
     autoload :Position,       "stupidedi/reader/position"
+    autoload :LazyPosition,   "stupidedi/reader/lazy_position"
+    autoload :LineIndex,      "stupidedi/reader/line_index"
     autoload :AbstractInput,  "stupidedi/reader/input/abstract_input"
+    autoload :BufferedInput,  "stupidedi/reader/input/buffered_input"
     autoload :DelegatedInput, "stupidedi/reader/input/delegated_input"
     autoload :FileInput,      "stupidedi/reader/input/file_input"
 
@@ -39,7 +43,7 @@ module Stupidedi
 
     # @private
     # @return [String]
-    C_BYTES    = (0..255).inject(""){|string, c| string + [c].pack('U') }
+    C_BYTES    = (0..255).inject(""){|string, c| string + [c].pack('U') }.freeze
 
     # @private
     # @return [Hash]
@@ -53,6 +57,13 @@ module Stupidedi
     # @return [Hash]
     H_EITHER   = C_BYTES.scan(R_EITHER).inject({}){|h,c| h[c] = nil; h }.freeze
 
+    # Matches the control characters in an `ASCII-8BIT` string. Bytes above
+    # 127 aren't decoded, so they're never control characters
+    #
+    # @private
+    # @return [Regexp]
+    R_CONTROL_BYTES = Regexp.new("[\\x00-\\x1F\\x7F]", Regexp::NOENCODING).freeze
+
     # @private
     # @return [Regexp]
     #_CONTROL  = Regexp.new("[^#{Regexp.quote(H_EITHER.keys.join)}]")
@@ -61,9 +72,32 @@ module Stupidedi
       # @group Constructors
       #########################################################################
 
+      # The `:tokenizer` option selects the class used to tokenize each
+      # interchange after its ISA segment. {SegmentScanner} produces the same
+      # tokens as the default, {TokenReader}, but is much faster on large
+      # inputs.
+      #
+      # When the `:lazy_positions` option is true, the line and column of each
+      # token are only computed when requested (see {LazyPosition}).
+      #
+      # When the `:binary` option is true, the input is read as `ASCII-8BIT`
+      # (see {Input.binary}), so offsets count bytes. Strings in other
+      # encodings, especially those with multibyte characters or invalid
+      # bytes, are much slower to index. {SegmentScanner} is the default
+      # tokenizer in this mode, and checks each segment for control characters
+      # with one regular expression. Bytes above 127 are kept as data without
+      # checking their encoding, so element values are `ASCII-8BIT` strings
+      # that can be copied to another encoding when they're used, eg with
+      # `String.new(value, :encoding => Encoding::ISO_8859_1)`.
+      #
       # @return [StreamReader]
-      def build(input)
-        StreamReader.new(Input.build(input))
+      def build(input, options = {})
+        binary = options.fetch(:binary, false)
+
+        input = Input.build(binary ? Input.binary(input) : input)
+        input = input.lazy_positions if options.fetch(:lazy_positions, false)
+
+        StreamReader.new(input, options.fetch(:tokenizer, binary ? SegmentScanner : TokenReader))
       end
 
       # @endgroup
@@ -74,7 +108,8 @@ module Stupidedi
       #
       # @see X222.pdf B.1.1.2.4 Control Characters
       def is_control_character?(character)
-        not H_EITHER.include?(character)
+        not H_EITHER.include?(character) and
+          not (character.encoding == Encoding::BINARY and character.ord > 127)
       end
 
       # @private
@@ -16,7 +16,7 @@ module Stupidedi
         when AbstractInput
           o
         when IO
-          FileInput.new(o, *args)
+          BufferedInput.new(o, *args)
         when String, Array
           DelegatedInput.new(o, *args)
         else
@@ -24,6 +24,22 @@ module Stupidedi
         end
       end
 
+      # Returns `o` with its contents encoded as `ASCII-8BIT`, which is a copy
+      # when `o` is a `String` in another encoding. An `IO` is switched to
+      # binary mode, and other inputs are returned as they are.
+      #
+      # @return [String, IO, AbstractInput]
+      def binary(o)
+        case o
+        when String
+          o.encoding == Encoding::BINARY ? o : o.b
+        when IO
+          o.binmode
+        else
+          o
+        end
+      end
+
       # @endgroup
       #########################################################################
     end
@@ -10,7 +10,8 @@ module Stupidedi
     #
     # The {DelegatedInput} subclass wraps values that already implement the
     # interface, like `String` and `Array`. The {FileInput} subclass wraps
-    # opened `IO` streams like `File`, and possibly others.
+    # opened `IO` streams like `File`, and possibly others. The {BufferedInput}
+    # subclass wraps the same kinds of streams, but reads them in large blocks.
     #
     # @example Reading the input
     #   input = Input.build("abc")
@@ -83,6 +84,26 @@ module Stupidedi
 
       def_delegators :position, :path
 
+      # Returns an equivalent input whose {#position} is a {LazyPosition}, so
+      # the line and column aren't tracked as the cursor advances, but are
+      # computed only when requested. Inputs that don't support this return
+      # themselves.
+      #
+      # @return [AbstractInput]
+      def lazy_positions
+        self
+      end
+
+      # Finds the newlines before the cursor now, when the input has
+      # {#lazy_positions} that would otherwise read them from a stream when
+      # a line or column is requested. This lets positions be used after the
+      # stream is closed.
+      #
+      # @return [AbstractInput]
+      def scan_lines
+        self
+      end
+
       # @group Reading the Input
       ########################################################################
 
@@ -0,0 +1,260 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Reader
+    #
+    # Wraps a seekable `IO` stream like {FileInput}, but instead of issuing a
+    # `seek` and `read` for each character, it reads the stream in large blocks
+    # and serves {#at}, {#take}, and {#index} from the current block. Each
+    # value returned by {#drop} shares the same block buffer, which slides
+    # forward through the stream as the cursor advances.
+    #
+    # Like {FileInput}, offsets count bytes, not multibyte characters, and the
+    # returned strings are `ASCII-8BIT` encoded.
+    #
+    # @note This class is not thread-safe. If more than one `Thread` has access
+    # to the same instance, and they simultaneously call methods on that
+    # instance, the methods may produce incorrect results and the object might
+    # be left in an inconsistent state.
+    #
+    class BufferedInput < AbstractInput
+      # Number of bytes read from the stream at once
+      #
+      # @private
+      BLOCK_SIZE = 64 * 1024
+
+      # @return [IO]
+      attr_reader :io
+
+      def initialize(io, offset = 0, line = 1, column = 1, size = io.stat.size, window = nil, lines = nil)
+        @io, @offset, @line, @column, @size, @window, @lines =
+          io, offset, line, column, size, window || Window.new(io, offset + size), lines
+      end
+
+      # @group Querying the Position
+      ########################################################################
+
+      # (see AbstractInput#offset)
+      attr_reader :offset
+
+      # (see AbstractInput#line)
+      def line
+        @lines.nil? ? @line : @lines.line(@offset)
+      end
+
+      # (see AbstractInput#column)
+      def column
+        @lines.nil? ? @column : @lines.column(@offset)
+      end
+
+      # (see AbstractInput#path)
+      def path
+        @io.path if @io.respond_to?(:path)
+      end
+
+      # (see AbstractInput#position)
+      def position
+        if @lines.nil?
+          Position.new(@offset, @line, @column, path)
+        else
+          LazyPosition.new(@offset, @lines)
+        end
+      end
+
+      # (see AbstractInput#lazy_positions)
+      def lazy_positions
+        return self unless @lines.nil?
+
+        # Newlines are found using a separate block buffer, so looking up a
+        # line number doesn't evict the block that's being tokenized
+        window = Window.new(@io, @offset + @size)
+        lines  = LineIndex.new(@offset, @line, @column, path) do |offset|
+          newline = window.index("\n", offset)
+          offset + newline unless newline.nil?
+        end
+
+        copy(:lines => lines)
+      end
+
+      # (see AbstractInput#scan_lines)
+      def scan_lines
+        @lines.scan(@offset) unless @lines.nil?
+        self
+      end
+
+      # @group Reading the Input
+      ########################################################################
+
+      # (see AbstractInput#take)
+      # @return [String]
+      def take(n)
+        raise ArgumentError, "n must be positive" unless n >= 0
+
+        @window.read(@offset, (n <= @size) ? n : @size)
+      end
+
+      # (see AbstractInput#at)
+      # @return [String]
+      def at(n)
+        raise ArgumentError, "n must be positive" unless n >= 0
+
+        @window.read(@offset + n, 1) if n < @size
+      end
+
+      # (see AbstractInput#index)
+      def index(element)
+        @window.index(element, @offset)
+      end
+
+      # @group Advancing the Cursor
+      ########################################################################
+
+      # (see AbstractInput#drop)
+      def drop(n)
+        raise ArgumentError, "n must be positive" unless n >= 0
+
+        unless @lines.nil?
+          # The LineIndex computes the line and column when they're requested
+          length = (n <= @size) ? n : @size
+          return copy(:offset => @offset + length, :size => @size - length)
+        end
+
+        prefix = take(n)
+        length = prefix.bytesize
+        count  = prefix.count("\n")
+
+        column = unless count.zero?
+                   length - prefix.rindex("\n")
+                 else
+                   @column + length
+                 end
+
+        copy(:offset => @offset + length,
+             :line   => @line + count,
+             :column => column,
+             :size   => @size - length)
+      end
+
+      # @group Testing the Input
+      ########################################################################
+
+      # (see AbstractInput#defined_at?)
+      def defined_at?(n)
+        n < @size
+      end
+
+      # (see AbstractInput#empty?)
+      def empty?
+        @size <= 0
+      end
+
+      # @endgroup
+      ########################################################################
+
+      # @return [void]
+      # :nocov:
+      def pretty_print(q)
+        q.text("BufferedInput")
+        q.group(2, "(", ")") do
+          preview = take(4)
+          preview = if preview.empty?
+                      "EOF"
+                    elsif preview.length <= 3
+                      preview.inspect
+                    else
+                      (preview.take(3) + "...").inspect
+                    end
+
+          q.text preview
+          q.text " at line #{line}, column #{column}, offset #{@offset}"
+          q.text ", file #{File.basename(path)}" unless path.nil?
+        end
+      end
+      # :nocov:
+
+      #
+      # Holds the most recently read block of the stream. The block is
+      # replaced when a read falls outside of it, so reading forward through
+      # the stream costs one `read` call per {BLOCK_SIZE} bytes.
+      #
+      # @private
+      class Window
+        def initialize(io, limit, block_size = BLOCK_SIZE)
+          @io, @limit, @block_size =
+            io, limit, block_size
+
+          @start  = 0
+          @buffer = String.new(:encoding => Encoding::BINARY)
+        end
+
+        # Returns up to `length` bytes starting at the absolute `offset`
+        #
+        # @return [String]
+        def read(offset, length)
+          unless covers?(offset, length)
+            fill(offset, length)
+          end
+
+          @buffer.byteslice(offset - @start, length)
+        end
+
+        # Returns the number of bytes between `offset` and the first
+        # occurrence of `element`, or nil if it does not occur
+        #
+        # @return [Integer]
+        def index(element, offset)
+          element = element.b
+          length  = element.bytesize
+          cursor  = offset
+
+          while cursor < @limit
+            unless covers?(cursor, length)
+              fill(cursor, length)
+            end
+
+            found = @buffer.index(element, cursor - @start)
+            return @start + found - offset unless found.nil?
+
+            # Stop when the block reaches the end of the stream. Otherwise,
+            # overlap the next block with the last `length - 1` bytes, in case
+            # `element` straddles the boundary between blocks.
+            finish = @start + @buffer.bytesize
+            return nil if finish >= @limit or @buffer.empty?
+            cursor = [finish - length + 1, cursor + 1].max
+          end
+        end
+
+      private
+
+        def covers?(offset, length)
+          finish = @start + @buffer.bytesize
+
+          offset >= @start and
+            (offset + length <= finish or finish >= @limit)
+        end
+
+        def fill(offset, length)
+          @io.seek(offset)
+          @start  = offset
+          @buffer = @io.read((length > @block_size) ? length : @block_size) ||
+            String.new(:encoding => Encoding::BINARY)
+        end
+      end
+
+    private
+
+      # @return [BufferedInput]
+      def copy(changes = {})
+        BufferedInput.new \
+          changes.fetch(:io, @io),
+          changes.fetch(:offset, @offset),
+          changes.fetch(:line, @line),
+          changes.fetch(:column, @column),
+          changes.fetch(:size, @size),
+          @window,
+          changes.fetch(:lines, @lines)
+      end
+    end
+  end
+end
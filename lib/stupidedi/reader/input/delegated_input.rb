@@ -4,9 +4,9 @@ module Stupidedi
 
   module Reader
     class DelegatedInput < AbstractInput
-      def initialize(delegate, offset = 0, line = 1, column = 1)
-        @delegate, @offset, @line, @column =
-          delegate, offset, line, column
+      def initialize(delegate, offset = 0, line = 1, column = 1, lines = nil)
+        @delegate, @offset, @line, @column, @lines =
+          delegate, offset, line, column, lines
       end
 
       # @group Querying the Position
@@ -16,14 +16,35 @@ module Stupidedi
       attr_reader :offset
 
       # (see AbstractInput#line)
-      attr_reader :line
+      def line
+        @lines.nil? ? @line : @lines.line(@offset)
+      end
 
       # (see AbstractInput#column)
-      attr_reader :column
+      def column
+        @lines.nil? ? @column : @lines.column(@offset)
+      end
 
       # (see AbstractInput#position)
       def position
-        Position.new(@offset, @line, @column, nil)
+        if @lines.nil?
+          Position.new(@offset, @line, @column, nil)
+        else
+          LazyPosition.new(@offset, @lines)
+        end
+      end
+
+      # (see AbstractInput#lazy_positions)
+      def lazy_positions
+        return self unless @lines.nil? and @delegate.is_a?(String)
+
+        delegate, start = @delegate, @offset
+        lines = LineIndex.new(@offset, @line, @column, nil) do |offset|
+          newline = delegate.index("\n", offset - start)
+          newline + start unless newline.nil?
+        end
+
+        copy(:lines => lines)
       end
 
       # @group Reading the Input
@@ -46,6 +67,13 @@ module Stupidedi
         raise ArgumentError, "n must be positive" unless n >= 0
 
         suffix = @delegate.drop(n)
+
+        unless @lines.nil?
+          # The LineIndex computes the line and column when they're requested
+          length = (n <= @delegate.length) ? n : @delegate.length
+          return copy(:delegate => suffix, :offset => @offset + length)
+        end
+
         prefix = @delegate.take(n)
 
         length = prefix.length
@@ -93,7 +121,7 @@ module Stupidedi
                     end
 
           q.text preview
-          q.text " at line #{@line}, column #{@column}, offset #{@offset}"
+          q.text " at line #{line}, column #{column}, offset #{@offset}"
         end
       end
 
@@ -105,7 +133,8 @@ module Stupidedi
           changes.fetch(:delegate, @delegate),
           changes.fetch(:offset, @offset),
           changes.fetch(:line, @line),
-          changes.fetch(:column, @column)
+          changes.fetch(:column, @column),
+          changes.fetch(:lines, @lines)
       end
     end
   end
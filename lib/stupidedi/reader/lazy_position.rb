@@ -0,0 +1,37 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Reader
+    #
+    # A {Position} that only stores its offset. The line, column, and path are
+    # computed from a {LineIndex} shared with other positions from the same
+    # input, and only when they are requested, which is usually only when an
+    # error is reported.
+    #
+    class LazyPosition < Position
+      # @return [LineIndex]
+      attr_reader :lines
+
+      def initialize(offset, lines)
+        @offset = offset
+        @lines  = lines
+      end
+
+      # @return [Integer]
+      def line
+        @lines.line(@offset)
+      end
+
+      # @return [Integer]
+      def column
+        @lines.column(@offset)
+      end
+
+      # @return [String, Pathname]
+      def path
+        @lines.path
+      end
+    end
+  end
+end
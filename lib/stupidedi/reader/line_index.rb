@@ -0,0 +1,102 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Reader
+    #
+    # Converts offsets within an input to line and column numbers. The offsets
+    # of each newline are found on demand, the first time a line or column at
+    # or beyond them is requested, and are remembered for later queries. One
+    # instance is shared by every {LazyPosition} within the same input.
+    #
+    # When the input is a stream, the parser calls {#scan} when it stops
+    # reading, because the stream may be closed before a line is requested.
+    #
+    # @note This class is not thread-safe. If more than one `Thread` has access
+    # to the same instance, and they simultaneously call methods on that
+    # instance, the methods may produce incorrect results and the object might
+    # be left in an inconsistent state.
+    #
+    class LineIndex
+      # @return [String, Pathname]
+      attr_reader :path
+
+      # The `scan` block is called with an offset and must return the offset
+      # of the first newline at or after it, or nil if there are no more
+      # newlines. The `offset`, `line`, and `column` arguments describe the
+      # position where the input begins.
+      #
+      # @yieldparam [Integer] offset
+      # @yieldreturn [Integer, nil]
+      def initialize(offset, line, column, path, &scan)
+        @offset, @line, @column, @path, @scan =
+          offset, line, column, path, scan
+
+        @newlines = []
+        @scanned  = offset
+        @finished = false
+      end
+
+      # @return [Integer]
+      def line(offset)
+        @line + count(offset)
+      end
+
+      # @return [Integer]
+      def column(offset)
+        count = count(offset)
+
+        if count.zero?
+          @column + offset - @offset
+        else
+          offset - @newlines.at(count - 1)
+        end
+      end
+
+      # @return [Position]
+      def position(offset)
+        Position.new(offset, line(offset), column(offset), @path)
+      end
+
+      # Finds every newline before `offset` now, so later queries for those
+      # offsets don't call the `scan` block
+      #
+      # @return [LineIndex]
+      def scan(offset)
+        count(offset)
+        self
+      end
+
+      # @return [void]
+      # :nocov:
+      def pretty_print(q)
+        q.text "LineIndex"
+        q.group(2, "(", ")") do
+          q.breakable ""
+          q.text "#{@newlines.length} newlines before offset #{@scanned}"
+        end
+      end
+      # :nocov:
+
+    private
+
+      # Returns the number of newlines that occur before `offset`
+      #
+      # @return [Integer]
+      def count(offset)
+        until @finished or @scanned >= offset
+          newline = @scan.call(@scanned)
+
+          if newline.nil?
+            @finished = true
+          else
+            @newlines << newline
+            @scanned   = newline + 1
+          end
+        end
+
+        @newlines.bsearch_index{|x| x >= offset } || @newlines.length
+      end
+    end
+  end
+end
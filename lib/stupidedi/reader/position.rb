@@ -23,10 +23,10 @@ module Stupidedi
 
       def copy(changes = {})
         Position.new \
-          changes.fetch(:offset, @offset),
-          changes.fetch(:line, @line),
-          changes.fetch(:column, @column),
-          changes.fetch(:path, @path)
+          changes.fetch(:offset, offset),
+          changes.fetch(:line, line),
+          changes.fetch(:column, column),
+          changes.fetch(:path, path)
       end
 
       def to_s
@@ -35,14 +35,14 @@ module Stupidedi
 
       # @return [String]
       def inspect
-        if @path.present?
-          parts = ["file #{@path}", "line #{@line}"]
+        if path.present?
+          parts = ["file #{path}", "line #{line}"]
         else
-          parts = ["line #{@line}"]
+          parts = ["line #{line}"]
         end
 
-        if @column.present?
-          parts << "column #{@column}"
+        if column.present?
+          parts << "column #{column}"
         end
 
         parts.join(", ")
@@ -53,16 +53,16 @@ module Stupidedi
         q.text "Position"
         q.group(2, "(", ")") do
           q.breakable ""
-          q.text "line #{@line},"
+          q.text "line #{line},"
           q.breakable
-          q.text "column #{@column},"
+          q.text "column #{column},"
           q.breakable
-          q.text "offset #{@offset}"
+          q.text "offset #{offset}"
 
-          unless @path.nil?
+          unless path.nil?
             q.text ","
             q.breakable
-            q.text "path #{@path}"
+            q.text "path #{path}"
           end
         end
       end
@@ -127,7 +127,7 @@ module Stupidedi
         def pretty_print(q)
           q.text "SegmentDict.empty"
         end
-      end.new
+      end.new.freeze
 
       # @private
       class Constants
@@ -0,0 +1,274 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Reader
+    #
+    # Tokenizes the same input as {TokenReader}, and produces the same tokens,
+    # but instead of reading one character at a time, it locates the segment
+    # terminator with a single call to {AbstractInput#index}, then splits the
+    # segment on the element, repetition, and component separators.
+    #
+    # Positions of each token are computed from the segment's position, so the
+    # input is only advanced once per segment. Segments that contain control
+    # characters, or are otherwise irregular, are handed to {TokenReader},
+    # which skips the control characters and reports errors exactly as before.
+    #
+    # @example
+    #   Reader.build(input, :tokenizer => Reader::SegmentScanner)
+    #
+    class SegmentScanner
+      # @private
+      R_CONTROL = /[\x00-\x1F\x7F]/
+
+      include Inspect
+
+      # @return [AbstractInput]
+      attr_reader :input
+
+      # @return [Separators]
+      attr_reader :separators
+
+      # @return [SegmentDict]
+      attr_accessor :segment_dict
+
+      def initialize(input, separators, segment_dict = SegmentDict.empty)
+        @input, @separators, @segment_dict =
+          input, separators, segment_dict
+      end
+
+      # @return [SegmentScanner]
+      def copy(changes = {})
+        SegmentScanner.new \
+          changes.fetch(:input, @input),
+          changes.fetch(:separators, @separators),
+          changes.fetch(:segment_dict, @segment_dict)
+      end
+
+      # @return false
+      def stream?
+        false
+      end
+
+      # @return [StreamReader]
+      def stream
+        StreamReader.new(@input, SegmentScanner)
+      end
+
+      def empty?
+        @input.empty?
+      end
+
+      # @return [Either<Result<SegmentTok, SegmentScanner>>]
+      def read_segment
+        input  = consume_control_chars
+        length = input.index(@separators.segment)
+        return fallback(input) if length.nil?
+
+        buffer = input.take(length)
+        return fallback(input) if has_control_characters?(buffer)
+
+        finish = buffer.index(@separators.element) || length
+        segment_id = buffer[0, finish]
+        return fallback(input) unless segment_id.match?(TokenReader::SEGMENT_ID)
+
+        segment_id = segment_id.to_sym
+        start      = input.position
+        rest       = input.drop(length + 1)
+        stop       = rest.position
+        elements   = []
+
+        if finish < length
+          if @segment_dict.defined_at?(segment_id)
+            element_uses = @segment_dict.at(segment_id).element_uses
+          else
+            element_uses = []
+          end
+
+          offset   = finish + 1
+          position = advance(start, offset)
+          values   = split(buffer[offset..-1], @separators.element)
+
+          values.each_with_index do |value, n|
+            # The remainder of each element is the position of the next one,
+            # and the remainder of the last is the end of the segment
+            following =
+              if n == values.length - 1
+                stop
+              else
+                advance(start, offset + value.length + 1)
+              end
+
+            elements << element(value, offset, start, element_uses.at(n), position, following)
+            offset   += value.length + 1
+            position  = following
+          end
+        end
+
+        remainder =
+          if segment_id == :IEA
+            StreamReader.new(rest, SegmentScanner)
+          else
+            copy(:input => rest)
+          end
+
+        result(SegmentTok.build(segment_id, elements, start, stop), remainder)
+      end
+
+      # @return [void]
+      def pretty_print(q)
+        q.text("SegmentScanner")
+        q.group(2, "(", ")") do
+          q.breakable ""
+
+          q.pp @input
+          q.text ","
+          q.breakable
+
+          q.pp @separators
+        end
+      end
+
+    private
+
+      # @return [AbstractInput]
+      def consume_control_chars
+        position = 0
+
+        while @input.defined_at?(position) and is_control?(@input.at(position))
+          position += 1
+        end
+
+        position.zero? ? @input : @input.drop(position)
+      end
+
+      # Tokenizes the element `value`, which begins `offset` characters from
+      # the `start` of the segment, according to its `element_use`. The given
+      # `position` and `remainder` are the positions before and after `value`
+      # and the delimiter that follows it.
+      #
+      # @return [SimpleElementTok, CompositeElementTok, RepeatedElementTok]
+      def element(value, offset, start, element_use, position, remainder)
+        if element_use.nil?
+          SimpleElementTok.build(value, position, remainder)
+        elsif element_use.repeatable?
+          occurrences = split(value, @separators.repetition)
+          tokens      = []
+
+          occurrences.each_with_index do |occurrence, n|
+            following =
+              if n == occurrences.length - 1
+                remainder
+              else
+                advance(start, offset + occurrence.length + 1)
+              end
+
+            tokens << if element_use.composite?
+                        composite(occurrence, offset, start, position, following)
+                      else
+                        SimpleElementTok.build(occurrence, position, following)
+                      end
+
+            offset  += occurrence.length + 1
+            position = following
+          end
+
+          # Like TokenReader, the position of a repeated element is the
+          # position of its last occurrence
+          RepeatedElementTok.build(tokens, tokens.last.position)
+        elsif element_use.composite?
+          composite(value, offset, start, position, remainder)
+        else
+          SimpleElementTok.build(value, position, remainder)
+        end
+      end
+
+      # @return [CompositeElementTok]
+      def composite(value, offset, start, position, remainder)
+        components = split(value, @separators.component)
+        finish     = advance(start, offset + value.length)
+        first      = position
+
+        components = components.map.with_index do |component, n|
+          following =
+            if n == components.length - 1
+              remainder
+            else
+              advance(start, offset + component.length + 1)
+            end
+
+          token    = ComponentElementTok.build(component, position, following)
+          offset  += component.length + 1
+          position = following
+          token
+        end
+
+        CompositeElementTok.build(components, first, finish)
+      end
+
+      # Segments that reach this point don't contain any newlines, so the
+      # position `n` characters from `start` is on the same line
+      #
+      # @return [Position]
+      def advance(start, n)
+        case start
+        when LazyPosition
+          LazyPosition.new(start.offset + n, start.lines)
+        when Position
+          Position.new(start.offset + n, start.line, start.column + n, start.path)
+        end
+      end
+
+      # Unlike `String#split`, this returns `[""]` for an empty string and
+      # doesn't discard trailing empty strings
+      #
+      # @return [Array<String>]
+      def split(string, separator)
+        if separator.nil? or not string.include?(separator)
+          [string]
+        else
+          string.split(separator, -1)
+        end
+      end
+
+      # Reads the segment at `input` with {TokenReader}, which handles control
+      # characters and produces descriptive errors for malformed input
+      #
+      # @return [Either<Result<SegmentTok, SegmentScanner>>]
+      def fallback(input)
+        TokenReader.new(input, @separators, @segment_dict).read_segment.flatmap do |token, remainder|
+          if remainder.stream?
+            result(token, StreamReader.new(remainder.input, SegmentScanner))
+          else
+            result(token, copy(:input => remainder.input))
+          end
+        end
+      end
+
+      def has_control_characters?(string)
+        if string.encoding == Encoding::BINARY
+          string.match?(Reader::R_CONTROL_BYTES)
+        elsif string.ascii_only?
+          string.match?(R_CONTROL)
+        else
+          string.each_char.any?{|c| Reader.is_control_character?(c) }
+        end
+      end
+
+      def is_delimiter?(character)
+        character == @separators.segment   or
+        character == @separators.element   or
+        character == @separators.component or
+        character == @separators.repetition
+      end
+
+      def is_control?(character)
+        Reader.is_control_character?(character) and not is_delimiter?(character)
+      end
+
+      def result(value, remainder)
+        Result.success(value, remainder)
+      end
+    end
+  end
+end
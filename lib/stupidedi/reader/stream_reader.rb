@@ -5,8 +5,8 @@ module Stupidedi
   module Reader
     #
     # The {StreamReader} is intended to scan the input for a valid ISA segment,
-    # after which the {TokenReader} class can be used to tokenize the remaining
-    # input.
+    # after which the {TokenReader} class, or another tokenizer like
+    # {SegmentScanner}, can be used to tokenize the remaining input.
     #
     # Because X12 specifications have no bearing on what happens outside the
     # interchange envelope (from `IEA` to `ISA`), out-of-band data like blank
@@ -18,8 +18,11 @@ module Stupidedi
 
       attr_reader :input
 
-      def initialize(input)
-        @input = input
+      # @return [Class<TokenReader>, Class<SegmentScanner>]
+      attr_reader :tokenizer
+
+      def initialize(input, tokenizer = TokenReader)
+        @input, @tokenizer = input, tokenizer
       end
 
       # @return true
@@ -101,7 +104,7 @@ module Stupidedi
                     token = SegmentTok.build(:ISA, elements,
                       rest.input.position, dR.input.position)
 
-                    result(token, TokenReader.new(dR.input, separators))
+                    result(token, @tokenizer.new(dR.input, separators))
                   end
                 end
               end
@@ -153,7 +156,7 @@ module Stupidedi
         unless @input.defined_at?(n-1)
           raise IndexError, "less than #{n} characters available"
         else
-          StreamReader.new(@input.drop(n))
+          StreamReader.new(@input.drop(n), @tokenizer)
         end
       end
 
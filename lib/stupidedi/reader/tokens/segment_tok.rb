@@ -27,19 +27,19 @@ module Stupidedi
       def copy(changes = {})
         SegmentTok.new \
           changes.fetch(:id, @id),
-          changes.fetch(:element_toks, @element_toks),
+          changes.fetch(:element_toks) { element_toks },
           changes.fetch(:position, @position),
           changes.fetch(:remainder, @remainder)
       end
 
       # :nocov:
       def pretty_print(q)
-        q.pp(:segment.cons(@id.cons(@element_toks)))
+        q.pp(:segment.cons(@id.cons(element_toks)))
       end
       # :nocov:
 
       def blank?
-        @element_toks.all?(&:blank?)
+        element_toks.all?(&:blank?)
       end
 
       def present?
@@ -50,7 +50,7 @@ module Stupidedi
         if blank?
           "#{id}#{separators.segment}"
         else
-          es  = @element_toks.map{|x| x.to_x12(separators) }
+          es  = element_toks.map{|x| x.to_x12(separators) }
           sep = separators.element || "*"
           eos = separators.segment || "~"
           id.cons(es).join(sep).gsub(/#{Regexp.escape(sep)}+$/, "") + eos.strip
@@ -23,6 +23,53 @@ module Stupidedi
     autoload :SegmentReq,           "stupidedi/schema/segment_req"
     autoload :RepeatCount,          "stupidedi/schema/repeat_count"
     autoload :SyntaxNote,           "stupidedi/schema/syntax_note"
+    autoload :SyntaxNoteEvaluator,  "stupidedi/schema/syntax_note_evaluator"
     autoload :CodeList,             "stupidedi/schema/code_list"
   end
+
+  class << Schema
+    # Freezes `definition` and every definition, element use, code list, and
+    # syntax note that it refers to, along with the arrays, hashes, sets,
+    # and strings that hold them. Other objects, like modules and procs, are
+    # left as they are and aren't searched.
+    #
+    # @return [Object] definition
+    def deep_freeze(definition)
+      stack = [definition]
+      seen  = {}.compare_by_identity
+
+      until stack.empty?
+        object = stack.pop
+        next if seen.key?(object) or not freezable?(object)
+        seen[object] = true
+
+        case object
+        when Array, Set
+          stack.concat(object.to_a)
+        when Hash
+          object.each{|k, v| stack << k << v }
+        when String
+        else
+          object.instance_variables.each{|v| stack << object.instance_variable_get(v) }
+        end
+
+        object.freeze
+      end
+
+      definition
+    end
+
+  private
+
+    def freezable?(object)
+      case object
+      when Schema::AbstractDef, Schema::AbstractUse, Schema::SyntaxNote,
+           Schema::SyntaxNoteEvaluator, Schema::CodeList, Schema::RepeatCount,
+           Schema::ElementReq, Schema::SegmentReq, Array, Hash, Set, String
+        true
+      else
+        false
+      end
+    end
+  end
 end
@@ -13,6 +13,9 @@ module Stupidedi
       # @return [Array<SyntaxNote>]
       attr_reader :syntax_notes
 
+      # @return [SyntaxNoteEvaluator]
+      attr_reader :syntax_note_evaluator
+
       # @return [CompositeElementUse]
       attr_reader :parent
 
@@ -20,6 +23,8 @@ module Stupidedi
         @id, @name, @description, @component_uses, @syntax_notes, @parent =
           id, name, description, component_uses, syntax_notes, parent
 
+        @syntax_note_evaluator = SyntaxNoteEvaluator.new(syntax_notes)
+
         # Delay re-parenting until the entire definition tree has a root
         # to prevent unnecessarily copying objects
         unless parent.nil?
@@ -34,7 +34,7 @@ module Stupidedi
         def initialize
           @max = 1
         end
-      end.new
+      end.new.freeze
 
       # @private
       Unbounded = Class.new(RepeatCount) do
@@ -57,7 +57,7 @@ module Stupidedi
         def inspect
           ">1"
         end
-      end.new
+      end.new.freeze
     end
 
     class << RepeatCount
@@ -24,6 +24,9 @@ module Stupidedi
       # @return [Array<SyntaxNote>]
       attr_reader :syntax_notes
 
+      # @return [SyntaxNoteEvaluator]
+      attr_reader :syntax_note_evaluator
+
       # @return [SegmentUse]
       attr_reader :parent
 
@@ -31,6 +34,8 @@ module Stupidedi
         @id, @name, @purpose, @element_uses, @syntax_notes, @parent =
           id, name, purpose.join, element_uses, syntax_notes, parent
 
+        @syntax_note_evaluator = SyntaxNoteEvaluator.new(syntax_notes)
+
         # Delay re-parenting until the entire definition tree has a root
         # to prevent unnecessarily copying objects
         unless parent.nil?
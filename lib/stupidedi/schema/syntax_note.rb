@@ -18,8 +18,14 @@ module Stupidedi
       # @return [Array<Integer>]
       attr_reader :indexes
 
+      # The bitmask of {#indexes}, where bit `n - 1` is set for element `n`
+      #
+      # @return [Integer]
+      attr_reader :mask
+
       def initialize(indexes)
         @indexes = indexes
+        @mask    = indexes.inject(0){|mask, n| mask | (1 << (n - 1)) }
       end
 
       # Returns the AbstractElementVals from the given segment or composite
@@ -37,6 +43,10 @@ module Stupidedi
       # @return [String]
       abstract :reason, :args => %w(zipper)
 
+      # True if the syntax note is satisfied when only the elements in the
+      # bitmask `present` are present (see {SyntaxNoteEvaluator})
+      abstract :satisfied_by?, :args => %w(present)
+
       def satisfied?(zipper)
         forbidden(zipper).all?{|c| c.node.blank? } and
           required(zipper).all?{|c| c.node.present? }
@@ -0,0 +1,66 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Schema
+    #
+    # Checks every {SyntaxNote} of a {SegmentDef} or {CompositeElementDef}
+    # against a bitmask of the elements that are present, where bit `n - 1`
+    # is set when the `n`th element is present. Only the elements named by
+    # some syntax note are examined to build the bitmask, and each note is
+    # then checked with a few integer operations, instead of looking at the
+    # elements again for each note.
+    #
+    # @see SegmentDef#syntax_note_evaluator
+    # @see CompositeElementDef#syntax_note_evaluator
+    #
+    class SyntaxNoteEvaluator
+      # @return [Array<SyntaxNote>]
+      attr_reader :syntax_notes
+
+      # @return [Array<Integer>]
+      attr_reader :indexes
+
+      def initialize(syntax_notes)
+        @syntax_notes = syntax_notes
+        @indexes      = syntax_notes.flat_map(&:indexes).uniq.sort
+      end
+
+      # The bitmask of elements in `value`, a {Values::SegmentVal} or
+      # {Values::CompositeElementVal}, that are present and named by some
+      # syntax note
+      #
+      # @return [Integer]
+      def present(value)
+        children = value.children
+        present  = 0
+
+        @indexes.each do |n|
+          child    = children.at(n - 1)
+          present |= 1 << (n - 1) if child and child.present?
+        end
+
+        present
+      end
+
+      # The syntax notes that aren't satisfied by the elements in `present`
+      #
+      # @param present [Integer, Values::SegmentVal, Values::CompositeElementVal]
+      # @return [Array<SyntaxNote>]
+      def violations(present)
+        return [] if @syntax_notes.empty?
+
+        present = present(present) unless present.is_a?(Integer)
+        @syntax_notes.reject{|s| s.satisfied_by?(present) }
+      end
+
+      # @param present [Integer, Values::SegmentVal, Values::CompositeElementVal]
+      def satisfied?(present)
+        return true if @syntax_notes.empty?
+
+        present = present(present) unless present.is_a?(Integer)
+        @syntax_notes.all?{|s| s.satisfied_by?(present) }
+      end
+    end
+  end
+end
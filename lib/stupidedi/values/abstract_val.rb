@@ -15,7 +15,7 @@ module Stupidedi
 
       # @see X222.pdf B.1.3.10 Absence of Data
       def empty?
-        @children.all?(&:empty?)
+        children.all?(&:empty?)
       end
 
       abstract :leaf?
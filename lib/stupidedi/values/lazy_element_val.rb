@@ -0,0 +1,61 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Values
+    #
+    # A simple element whose text hasn't been converted to a typed value yet.
+    # The conversion, which can parse dates and decimals and compare the text
+    # to a code list, is done the first time the value is used, and then each
+    # method is delegated to the result. So a lazy value behaves exactly like
+    # the value that {Schema::SimpleElementUse#value} would have returned,
+    # except `#class` and `Module#===` see the {LazyElementVal} class.
+    #
+    # The parser only creates these when {Config#lazy_elements} is enabled.
+    #
+    class LazyElementVal < SimpleElementVal
+      # @return [String]
+      attr_reader :text
+
+      def initialize(text, usage, position)
+        super(usage, position)
+        @text = text
+      end
+
+      # The value that's constructed from {#text}
+      #
+      # @return [SimpleElementVal]
+      def materialize
+        @__materialize ||= @usage.value(@text, @position)
+      end
+
+      def_delegators :materialize, :empty?, :valid?, :invalid?, :present?,
+        :blank?, :separator?, :characters, :id?, :date?, :time?, :string?,
+        :numeric?, :allowed?, :to_s, :to_x12, :too_long?, :too_short?, :copy,
+        :==, :<=>, :inspect, :pretty_print
+
+      def is_a?(klass)
+        super or materialize.is_a?(klass)
+      end
+
+      alias kind_of? is_a?
+
+      def instance_of?(klass)
+        materialize.instance_of?(klass)
+      end
+
+      def respond_to_missing?(name, include_private = false)
+        materialize.respond_to?(name, include_private)
+      end
+
+      # Delegates type-specific methods, like `#to_d` or `#to_date`
+      def method_missing(name, *args, &block)
+        if materialize.respond_to?(name)
+          materialize.__send__(name, *args, &block)
+        else
+          super
+        end
+      end
+    end
+  end
+end
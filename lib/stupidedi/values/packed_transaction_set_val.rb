@@ -0,0 +1,399 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Values
+    #
+    # A {TransactionSetVal} that stores its segments in a few flat arrays
+    # instead of a tree of value objects. The text of every simple element is
+    # kept in one byte buffer, and packed integer arrays hold the length of
+    # each element's text, the element's position relative to its segment,
+    # and the number of repetitions and components of each repeated and
+    # composite element. The integers are BER-compressed (`Array#pack("w*")`)
+    # so most of them take one byte. Loops, tables, and {Schema::SegmentUse} values are
+    # stored as indexes into a table of definitions.
+    #
+    # The {TableVal}, {LoopVal}, {SegmentVal}, and element values are built
+    # again from these arrays each time {#children} or {#each_segment} is
+    # called, and they aren't retained, so a packed transaction set is much
+    # smaller than the parse tree it was built from. Segments that can't be
+    # rebuilt exactly, like an {InvalidSegmentVal}, are stored as they are.
+    #
+    # @see TransactionSetVal#pack
+    #
+    class PackedTransactionSetVal < TransactionSetVal
+      # @return [Integer]
+      attr_reader :size
+
+      def initialize(definition, size, table, shape, data, encoding, leaves,
+                     deltas, counts, segments, origin)
+        @definition, @size, @table, @shape, @data, @encoding, @leaves,
+          @deltas, @counts, @segments, @origin =
+          definition, size, table, shape, data, encoding, leaves,
+          deltas, counts, segments, origin
+      end
+
+      # @return [TransactionSetVal]
+      def copy(changes = {})
+        TransactionSetVal.new \
+          changes.fetch(:definition, @definition),
+          changes.fetch(:children) { children }
+      end
+
+      # Builds the tables of this transaction set, which aren't retained
+      #
+      # @return [Array<TableVal>]
+      def children
+        Unpacker.new(self).children
+      end
+
+      # @return [TransactionSetVal]
+      def unpack
+        TransactionSetVal.new(@definition, children)
+      end
+
+      # (see TransactionSetVal#pack)
+      # @return [PackedTransactionSetVal]
+      def pack
+        self
+      end
+
+      # Yields each {SegmentVal} and {InvalidSegmentVal} in order, without
+      # building the loops and tables that contain them
+      #
+      # @yieldparam [SegmentVal, InvalidSegmentVal]
+      # @return [void]
+      def each_segment(&block)
+        return enum_for(:each_segment) unless block_given?
+        Unpacker.new(self).each_segment(&block)
+      end
+
+      # @return [Position]
+      def position
+        each_segment.first.position
+      end
+
+      def empty?
+        each_segment.all?(&:empty?)
+      end
+
+      # @private
+      attr_reader :table, :shape, :data, :encoding, :leaves, :deltas, :counts,
+        :segments, :origin
+
+      #
+      # Rebuilds the values in the same order they were packed
+      #
+      # @private
+      #
+      class Unpacker
+        def initialize(packed)
+          @packed   = packed
+          @table    = packed.table
+          @shape    = packed.shape.unpack("w*")
+          @leaves   = packed.leaves.unpack("w*")
+          @deltas   = packed.deltas.unpack("w*")
+          @counts   = packed.counts.unpack("w*")
+          @segments = packed.segments.unpack("w*")
+          @stride   = packed.origin.is_a?(Reader::LazyPosition) ? 1 : 3
+
+          @shape_at, @leaf_at, @count_at, @segment_at, @data_at = 0, 0, 0, 0, 0
+        end
+
+        # @return [Array<TableVal>]
+        def children
+          values = []
+          values << node while @shape_at < @shape.length
+          values
+        end
+
+        # @return [void]
+        def each_segment
+          while @shape_at < @shape.length
+            entry = @table.at(@shape.at(@shape_at))
+
+            if entry.is_a?(Schema::TableDef) or entry.is_a?(Schema::LoopDef)
+              @shape_at += 2
+            elsif entry.is_a?(Schema::SegmentUse)
+              @shape_at += 1
+              yield segment(entry)
+            else
+              @shape_at += 1
+              yield entry
+            end
+          end
+        end
+
+      private
+
+        # @return [TableVal, LoopVal, SegmentVal, InvalidSegmentVal]
+        def node
+          entry      = @table.at(@shape.at(@shape_at))
+          @shape_at += 1
+
+          if entry.is_a?(Schema::TableDef)
+            TableVal.new(entry, group)
+          elsif entry.is_a?(Schema::LoopDef)
+            LoopVal.new(entry, group)
+          elsif entry.is_a?(Schema::SegmentUse)
+            segment(entry)
+          else
+            entry
+          end
+        end
+
+        # @return [Array<LoopVal, SegmentVal>]
+        def group
+          length     = @shape.at(@shape_at)
+          @shape_at += 1
+          Array.new(length) { node }
+        end
+
+        # @return [SegmentVal]
+        def segment(segment_use)
+          offset, line, column = @segments[@segment_at, @stride].map{|n| n - 1 unless n.zero? }
+          @segment_at += @stride
+
+          origin =
+            if @stride == 1
+              Reader::LazyPosition.new(offset, @packed.origin.lines)
+            else
+              Reader::Position.new(offset, line, column, @packed.origin.path)
+            end
+
+          element_vals = segment_use.definition.element_uses.map do |element_use|
+            if element_use.repeatable?
+              length     = @counts.at(@count_at)
+              @count_at += 1
+              RepeatedElementVal.build(Array.new(length) { occurrence(element_use, origin) }, element_use)
+            else
+              occurrence(element_use, origin)
+            end
+          end
+
+          segment_use.value(element_vals, origin)
+        end
+
+        # @return [SimpleElementVal, CompositeElementVal]
+        def occurrence(element_use, origin)
+          if element_use.simple?
+            simple(element_use, origin)
+          else
+            length     = @counts.at(@count_at)
+            @count_at += 1
+
+            component_uses = element_use.definition.component_uses
+            component_vals = component_uses.take(length).map{|u| simple(u, origin) }
+            element_use.value(component_vals, origin)
+          end
+        end
+
+        # @return [SimpleElementVal]
+        def simple(element_use, origin)
+          length    = @leaves.at(@leaf_at)
+          position  = PackedTransactionSetVal.rebase(origin, @deltas.at(@leaf_at))
+          @leaf_at += 1
+
+          if length.zero?
+            element_use.empty(position)
+          else
+            text      = @packed.data.byteslice(@data_at, length)
+            @data_at += length
+            element_use.value(text.force_encoding(@packed.encoding), position)
+          end
+        end
+      end
+
+      #
+      # Flattens the values of a transaction set into arrays
+      #
+      # @private
+      #
+      class Packer
+        def initialize
+          @index    = {}.compare_by_identity
+          @table    = []
+          @shape    = []
+          @data     = String.new(:encoding => Encoding::BINARY)
+          @encoding = nil
+          @leaves   = []
+          @deltas   = []
+          @counts   = []
+          @segments = []
+          @origin   = nil
+        end
+
+        # @return [PackedTransactionSetVal]
+        def pack(transaction_set_val)
+          transaction_set_val.children.each{|c| node(c) }
+
+          PackedTransactionSetVal.new(transaction_set_val.definition,
+            transaction_set_val.size, @table, @shape.pack("w*"), @data,
+            @encoding || Encoding::UTF_8, @leaves.pack("w*"),
+            @deltas.pack("w*"), @counts.pack("w*"), @segments.pack("w*"),
+            @origin)
+        end
+
+      private
+
+        # @return [void]
+        def node(value)
+          if value.instance_of?(TableVal) or value.instance_of?(LoopVal)
+            @shape << entry(value.definition) << value.children.length
+            value.children.each{|c| node(c) }
+          elsif value.instance_of?(SegmentVal) and segment(value)
+            @shape << entry(value.usage)
+          else
+            @shape << entry(value)
+          end
+        end
+
+        # @return [Integer]
+        def entry(object)
+          @index.fetch(object) do
+            @table << object
+            @index[object] = @table.length - 1
+          end
+        end
+
+        # Appends the segment to the arrays, unless the values that would be
+        # built from them wouldn't be the same as `segment_val`
+        #
+        # @return [Boolean]
+        def segment(segment_val)
+          origin        = segment_val.position
+          @origin     ||= origin
+          element_uses  = segment_val.usage.definition.element_uses
+
+          return false unless origin.class == @origin.class
+          return false unless element_uses.length == segment_val.children.length
+
+          if origin.is_a?(Reader::LazyPosition)
+            return false unless origin.lines.equal?(@origin.lines)
+          elsif origin.is_a?(Reader::Position)
+            return false unless origin.path == @origin.path
+          else
+            return false
+          end
+
+          texts, deltas, counts = [], [], []
+
+          packed = element_uses.zip(segment_val.children).all? do |element_use, element_val|
+            if element_use.repeatable?
+              RepeatedElementVal === element_val and
+                element_val.usage.equal?(element_use) and
+                counts.push(element_val.children.length) and
+                element_val.children.all?{|e| occurrence(element_use, e, origin, texts, deltas, counts) }
+            else
+              occurrence(element_use, element_val, origin, texts, deltas, counts)
+            end
+          end
+
+          if packed
+            if origin.is_a?(Reader::LazyPosition)
+              @segments << origin.offset + 1
+            else
+              @segments.push(*[origin.offset, origin.line, origin.column].map{|n| n ? n + 1 : 0 })
+            end
+
+            @deltas.concat(deltas)
+            @counts.concat(counts)
+
+            texts.each do |text|
+              @encoding ||= text.encoding unless text.empty?
+              @data   << text.b
+              @leaves << text.bytesize
+            end
+          end
+
+          packed
+        end
+
+        # @return [Boolean]
+        def occurrence(element_use, element_val, origin, texts, deltas, counts)
+          if element_use.simple?
+            simple(element_use, element_val, origin, texts, deltas)
+          else
+            CompositeElementVal === element_val and
+              element_val.usage.equal?(element_use) and
+              element_val.children.length <= element_use.definition.component_uses.length and
+              counts.push(element_val.children.length) and
+              element_use.definition.component_uses.zip(element_val.children).all? do |u, e|
+                e.nil? or simple(u, e, origin, texts, deltas)
+              end
+          end
+        end
+
+        # @return [Boolean]
+        def simple(element_use, element_val, origin, texts, deltas)
+          return false unless SimpleElementVal === element_val
+          return false unless element_val.usage.equal?(element_use)
+
+          position = element_val.position
+          delta    = position.try(:offset) && origin.offset ? position.offset - origin.offset : 0
+          return false unless position.class == origin.class and delta >= 0
+          return false unless same?(PackedTransactionSetVal.rebase(origin, delta), position)
+
+          text = text(element_val)
+          return false if text.empty? and not LazyElementVal === element_val and element_val.invalid?
+
+          texts  << text
+          deltas << delta
+        end
+
+        # The text from which `element_val` is constructed
+        #
+        # @return [String]
+        def text(element_val)
+          if LazyElementVal === element_val
+            element_val.text
+          elsif element_val.invalid?
+            element_val.value.to_s
+          elsif element_val.empty?
+            ""
+          else
+            element_val.to_x12(false)
+          end
+        end
+
+        # @return [Boolean]
+        def same?(a, b)
+          if a.is_a?(Reader::LazyPosition)
+            a.offset == b.offset and a.lines.equal?(b.lines)
+          else
+            a.offset == b.offset and a.line == b.line and
+              a.column == b.column and a.path == b.path
+          end
+        end
+      end
+    end
+
+    class << PackedTransactionSetVal
+      # @group Constructors
+      #########################################################################
+
+      # @return [PackedTransactionSetVal]
+      def pack(transaction_set_val)
+        PackedTransactionSetVal::Packer.new.pack(transaction_set_val)
+      end
+
+      # @endgroup
+      #########################################################################
+
+      # The position `delta` bytes after `origin`, on the same line
+      #
+      # @private
+      # @return [Reader::Position]
+      def rebase(origin, delta)
+        if delta.zero?
+          origin
+        elsif origin.is_a?(Reader::LazyPosition)
+          Reader::LazyPosition.new(origin.offset + delta, origin.lines)
+        else
+          Reader::Position.new(origin.offset + delta, origin.line,
+            origin.column.try{|c| c + delta }, origin.path)
+        end
+      end
+    end
+  end
+end
@@ -0,0 +1,49 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Values
+    #
+    # A segment that's outside the {Parser::Projection} given to the parser.
+    # Only the token that was read is stored, and the element values are
+    # built the first time {#children} is called, so a raw segment behaves
+    # like the {SegmentVal} the parser would have built otherwise.
+    #
+    # @see Config#projection
+    #
+    class RawSegmentVal < SegmentVal
+      # @return [Reader::SegmentTok]
+      attr_reader :segment_tok
+
+      def initialize(segment_tok, usage, lazy = false)
+        @segment_tok, @usage, @lazy = segment_tok, usage, lazy
+      end
+
+      # Builds the element values like the parser would have, including
+      # {LazyElementVal}s when {Config#lazy_elements} was enabled
+      #
+      # @return [Array<AbstractElementVal>]
+      def children
+        @children ||= Parser::AbstractState.__mksegment(@segment_tok, @usage, @lazy).children
+      end
+
+      # @return [Position]
+      def position
+        @segment_tok.position
+      end
+
+      # @return [SegmentVal]
+      def copy(changes = {})
+        SegmentVal.new \
+          changes.fetch(:children) { children },
+          changes.fetch(:usage, @usage),
+          changes.fetch(:position) { position }
+      end
+
+      # True if the elements haven't been built yet
+      def raw?
+        @children.nil?
+      end
+    end
+  end
+end
@@ -60,9 +60,9 @@ module Stupidedi
         end
 
         unless n.nil?
-          @children.at(m - 1).element(n, o)
+          children.at(m - 1).element(n, o)
         else
-          @children.at(m - 1)
+          children.at(m - 1)
         end
       end
 
@@ -76,7 +76,7 @@ module Stupidedi
         q.text(ansi.segment("SegmentVal#{id}"))
         q.group(2, "(", ")") do
           q.breakable ""
-          @children.each do |e|
+          children.each do |e|
             unless q.current_group.first?
               q.text ","
               q.breakable
@@ -98,7 +98,7 @@ module Stupidedi
       def ==(other)
         eql?(other) or
          (other.definition == definition and
-          other.children   == @children)
+          other.children   == children)
       end
     end
   end
@@ -15,6 +15,64 @@ module Stupidedi
       def leaf?
         false
       end
+
+      # Maps segment identifiers to the indexes of the children that either
+      # are a segment with that identifier, or contain a child that begins
+      # with one. When a segment's first element is an identifier, the pair
+      # `[id, value]` is also mapped, and otherwise `[id]` is mapped to true
+      # to indicate that element values can't be used to narrow the search.
+      #
+      # Values are never modified, so this is built once for each node, when
+      # it's first needed by {Parser::Navigation#find}. Edits to the tree make
+      # new nodes, which have their own index.
+      #
+      # @return [Hash<Symbol | Array, Array<Integer>>]
+      def segment_index
+        @__segment_index ||= begin
+          index = Hash.new{|h, k| h[k] = [] }
+
+          children.each_with_index do |child, n|
+            if child.segment?
+              segment_keys(child, index, n)
+            else
+              child.children.each do |grandchild|
+                grandchild = grandchild.children.first until grandchild.nil? or grandchild.segment?
+                segment_keys(grandchild, index, n) unless grandchild.nil?
+              end
+            end
+          end
+
+          index.default_proc = nil
+          index
+        end
+      end
+
+      # Indexes of the children that are segments
+      #
+      # @return [Array<Integer>]
+      def segment_offsets
+        @__segment_offsets ||= children.each_index.select{|n| children.at(n).segment? }
+      end
+
+    private
+
+      # @return [void]
+      def segment_keys(segment_val, index, n)
+        positions = index[segment_val.id]
+        positions << n unless positions.last == n
+        return if segment_val.invalid?
+
+        element_val = segment_val.children.first
+
+        if element_val.try(:simple?) and element_val.id?
+          if element_val.valid? and not element_val.empty?
+            positions = index[[segment_val.id, element_val.to_s]]
+            positions << n unless positions.last == n
+          end
+        else
+          index[[segment_val.id]] = true
+        end
+      end
     end
   end
 end
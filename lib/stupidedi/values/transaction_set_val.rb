@@ -43,7 +43,7 @@ module Stupidedi
         q.text(ansi.envelope("TransactionSetVal#{id}"))
         q.group(2, "(", ")") do
           q.breakable ""
-          @children.each do |e|
+          children.each do |e|
             unless q.current_group.first?
               q.text ","
               q.breakable
@@ -55,14 +55,22 @@ module Stupidedi
 
       # @return [String]
       def inspect
-        ansi.envelope("Transaction") + "(#{@children.map(&:inspect).join(", ")})"
+        ansi.envelope("Transaction") + "(#{children.map(&:inspect).join(", ")})"
+      end
+
+      # Stores this transaction set in a compact form, which constructs the
+      # {TableVal}, {LoopVal}, and {SegmentVal} values each time they're used
+      #
+      # @return [PackedTransactionSetVal]
+      def pack
+        PackedTransactionSetVal.pack(self)
       end
 
       # @return [Boolean]
       def ==(other)
         eql?(other) or
          (other.definition == @definition and
-          other.children   == @children)
+          other.children   == children)
       end
     end
   end
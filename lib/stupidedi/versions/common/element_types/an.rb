@@ -131,6 +131,9 @@ module Stupidedi
         # @see X222.pdf B.1.1.3.1.4 String
         #
         class StringVal < Values::SimpleElementVal
+          # Values no longer than this many bytes are interned by {.value}
+          INTERN_BYTESIZE = 10
+
           def string?
             true
           end
@@ -217,7 +220,7 @@ module Stupidedi
             extend Operators::Wrappers
             wrappers :%, :+, :*, :slice, :take, :drop, :[], :capitalize,
               :center, :ljust, :rjust, :chomp, :delete, :tr, :tr_s,
-              :sub, :gsub, :encode, :force_encoding, :squeeze
+              :sub, :gsub, :encode, :squeeze
 
             extend Operators::Unary
             unary_operators :chr, :chop, :upcase, :downcase, :strip,
@@ -244,6 +247,14 @@ module Stupidedi
               return StringVal.value(other, usage, position), self
             end
 
+            # The value may be shared by other elements, so this doesn't
+            # change it in place like `String#force_encoding`
+            #
+            # @return [StringVal]
+            def force_encoding(encoding)
+              copy(:value => value.dup.force_encoding(encoding))
+            end
+
             def valid?
               true
             end
@@ -356,7 +367,14 @@ module Stupidedi
             elsif object.kind_of?(Date) or object.kind_of?(Time)
               self::Invalid.new(object, usage, position)
             else
-              self::NonEmpty.new(object.to_s.rstrip, usage, position)
+              string = object.to_s.rstrip
+
+              # Short strings are often codes that occur many times, so each
+              # distinct string is shared by every occurrence (see the note
+              # in {IdentifierVal.value})
+              string = -string if string.bytesize <= StringVal::INTERN_BYTESIZE
+
+              self::NonEmpty.new(string, usage, position)
             end
           rescue
             self::Invalid.new(object, usage, position)
@@ -141,7 +141,7 @@ module Stupidedi
             extend Operators::Wrappers
             wrappers :%, :+, :*, :slice, :take, :drop, :[], :capitalize,
               :center, :ljust, :rjust, :chomp, :delete, :tr, :tr_s,
-              :sub, :gsub, :encode, :force_encoding, :squeeze
+              :sub, :gsub, :encode, :squeeze
 
             # (string -> StringVal)
             extend Operators::Unary
@@ -170,6 +170,14 @@ module Stupidedi
               return IdentifierVal.value(other, usage, position), self
             end
 
+            # The value may be shared by other elements, so this doesn't
+            # change it in place like `String#force_encoding`
+            #
+            # @return [IdentifierVal]
+            def force_encoding(encoding)
+              copy(:value => value.dup.force_encoding(encoding))
+            end
+
             # @return [IdentifierVal]
             def map
               IdentifierVal.value(yield(value), usage, position)
@@ -283,7 +291,11 @@ module Stupidedi
             elsif object.blank?
               self::Empty.new(usage, position)
             else
-              self::NonEmpty.new(object.to_s.rstrip, usage, position)
+              # Identifiers are mostly qualifiers and codes that occur many
+              # times, so each distinct string is shared by every occurrence.
+              # The value itself isn't shared, because it keeps the position
+              # of this occurrence for error reporting
+              self::NonEmpty.new(-object.to_s.rstrip, usage, position)
             end
           rescue
             self::Invalid.new(object, usage, position)
@@ -28,6 +28,11 @@ module Stupidedi
             []
           end
 
+          def satisfied_by?(present)
+            present &= mask
+            present.zero? or present == mask
+          end
+
           def reason(zipper)
             present = indexes.select{|n| zipper.child(n - 1).node.present? }
             missing = indexes - present
@@ -53,6 +58,10 @@ module Stupidedi
             []
           end
 
+          def satisfied_by?(present)
+            not (present & mask).zero?
+          end
+
           def reason(zipper)
             present = indexes.select{|n| zipper.child(n - 1).node.present? }
             missing = indexes - present
@@ -78,6 +87,11 @@ module Stupidedi
             # end
           end
 
+          def satisfied_by?(present)
+            present &= mask
+            (present & (present - 1)).zero?
+          end
+
           def reason(zipper)
             present = indexes.select{|n| zipper.child(n - 1).node.present? }
             "only one of elements #{present.join(", ")} may be present"
@@ -105,6 +119,12 @@ module Stupidedi
             []
           end
 
+          def satisfied_by?(present)
+            head = 1 << (indexes.head - 1)
+            tail = mask & ~head
+            (present & head).zero? or (present & tail) == tail
+          end
+
           def reason(zipper)
             "elements #{indexes.tail.join(", ")} must be present when element #{indexes.head} is present"
           end
@@ -132,6 +152,11 @@ module Stupidedi
             []
           end
 
+          def satisfied_by?(present)
+            head = 1 << (indexes.head - 1)
+            (present & head).zero? or not (present & mask & ~head).zero?
+          end
+
           def reason(zipper)
             "at least one of elements #{indexes.tail.join(", ")} must be present when element #{indexes.head} is present"
           end
@@ -1,7 +1,10 @@
 # frozen_string_literal: true
 module Stupidedi
   module Writer
+    autoload :Buffer,   "stupidedi/writer/buffer"
     autoload :Claredi,  "stupidedi/writer/claredi"
     autoload :Default,  "stupidedi/writer/default"
+    autoload :Json,     "stupidedi/writer/json"
+    autoload :Stream,   "stupidedi/writer/stream"
   end
 end
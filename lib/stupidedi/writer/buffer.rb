@@ -0,0 +1,45 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Writer
+    #
+    # Collects output in a `String` and appends it to an `IO` (or another
+    # `String`) in chunks of at least {#chunk_size} bytes, instead of writing
+    # each separator and element separately.
+    #
+    class Buffer
+      CHUNK_SIZE = 64 * 1024
+
+      # @return [IO, String]
+      attr_reader :io
+
+      # @return [Integer]
+      attr_reader :chunk_size
+
+      def initialize(io, chunk_size = CHUNK_SIZE)
+        @io, @chunk_size, @buffer =
+          io, chunk_size, String.new
+      end
+
+      # @return [Buffer]
+      def <<(string)
+        @buffer << string
+        flush if @buffer.bytesize >= @chunk_size
+        self
+      end
+
+      # Writes the buffered output to {#io}
+      #
+      # @return [Buffer]
+      def flush
+        unless @buffer.empty?
+          @io << @buffer
+          @buffer.clear
+        end
+
+        self
+      end
+    end
+  end
+end
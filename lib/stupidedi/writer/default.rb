@@ -11,19 +11,24 @@ module Stupidedi
           zipper, separators
       end
 
+      # Writes the tree to `out`, which can be a `String` or an `IO`. When it's
+      # an `IO`, the output is collected in a {Buffer} and written in chunks.
+      #
+      # Elements are checked for separator characters as they're written, so
+      # an exception can be raised after some of the output has been written.
+      # An interchange that's written with its own separators isn't checked.
+      #
       # @return out
       def write(out = "")
-        unless @zipper.node.transmission? or @zipper.node.interchange?
-          common  = @separators.characters & @zipper.node.characters
-          message = common.to_a.map(&:inspect).join(", ")
+        @check = !(@zipper.node.transmission? or @zipper.node.interchange?)
 
-          if common.present?
-            raise Exceptions::OutputError,
-              "separator characters #{message} occur as data"
-          end
+        if out.is_a?(String) or out.is_a?(Buffer)
+          recurse(@zipper.node, @separators, out)
+        else
+          Buffer.new(out).tap{|b| recurse(@zipper.node, @separators, b) }.flush
         end
 
-        out.tap { recurse(@zipper.node, @separators, out) }
+        out
       end
 
     private
@@ -35,30 +40,38 @@ module Stupidedi
           segment(value, separators, out)
         else
           if value.interchange?
-            unless separators.merge(value.separators) == separators
-              common  = separators.characters & value.characters
-              message = common.to_a.map(&:inspect).join(", ")
-
-              if common.present?
-                raise Exceptions::OutputError,
-                  "separator characters #{message} occur as data"
-              end
+            check = @check
+            value, separators, @check = interchange(value, separators)
+            value.children.each{|c| recurse(c, separators, out) }
+            @check = check
+          else
+            value.children.each{|c| recurse(c, separators, out) }
+          end
+        end
+      end
 
-              # Change ISA11 and ISA16
-              value = value.replace_separators(separators)
-            end
+      # Returns the interchange with ISA11 and ISA16 changed to the given
+      # separators, if they're different, the separators to use for its
+      # children, and whether they were changed
+      #
+      # @return [(Values::InterchangeVal, Reader::Separators, Boolean)]
+      def interchange(value, separators)
+        changed = separators.merge(value.separators) != separators
+
+        if changed
+          # Change ISA11 and ISA16
+          value = value.replace_separators(separators)
+        end
 
-            separators = value.separators
+        separators = value.separators
 
-            raise Exceptions::OutputError,
-              "separators.segment cannot be blank" if separators.segment.blank?
+        raise Exceptions::OutputError,
+          "separators.segment cannot be blank" if separators.segment.blank?
 
-            raise Exceptions::OutputError,
-              "separators.element cannot be blank" if separators.element.blank?
-          end
+        raise Exceptions::OutputError,
+          "separators.element cannot be blank" if separators.element.blank?
 
-          value.children.each{|c| recurse(c, separators, out) }
-        end
+        return value, separators, changed
       end
 
       def segment(s, separators, out)
@@ -72,12 +85,12 @@ module Stupidedi
 
         # Trailing empty elements (including component elements) can be omitted,
         # so "NM1*XX*1:2::::*****~" should be abbreviated to "NM1*XX*1:2~".
-        elements = s.children.
-          reverse.drop_while(&:empty?).reverse  # Remove the trailing empties
+        elements = s.children
+        last     = elements.rindex{|e| not e.empty? }
 
-        elements.each do |e|
+        0.upto(last) do |n|
           out << separators.element
-          element(e, separators, out)
+          element(elements.at(n), separators, out)
         end
 
         out << separators.segment
@@ -85,35 +98,68 @@ module Stupidedi
 
       def element(e, separators, out)
         if e.simple?
-          out << e.to_x12
+          simple(e, separators, out)
 
         elsif e.composite?
-          components = e.children.
-            reverse.drop_while(&:empty?).reverse
+          components = e.children
+          last       = components.rindex{|c| not c.empty? }
 
-          unless components.empty?
-            out << components.head.to_x12
+          unless last.nil?
+            simple(components.head, separators, out)
           end
 
-          components.tail.each do |c|
+          1.upto(last || 0) do |n|
             out << separators.component
-            out << c.to_x12
+            simple(components.at(n), separators, out)
           end
 
         elsif e.repeated?
-          occurrences = e.children.
-            reverse.drop_while(&:empty?).reverse
+          occurrences = e.children
+          last        = occurrences.rindex{|o| not o.empty? }
 
-          unless occurrences.empty?
+          unless last.nil?
             element(occurrences.head, separators, out)
           end
 
-          occurrences.tail.each do |o|
+          1.upto(last || 0) do |n|
             out << separators.repetition
-            element(o, separators, out)
+            element(occurrences.at(n), separators, out)
           end
         end
       end
+
+      def simple(e, separators, out)
+        x12 = e.to_x12
+
+        if @check and not x12.empty? and not e.separator?
+          pattern = pattern(separators)
+
+          if pattern and x12 =~ pattern
+            message = x12.scan(pattern).uniq.map(&:inspect).join(", ")
+
+            raise Exceptions::OutputError,
+              "separator characters #{message} occur as data"
+          end
+        end
+
+        out << x12
+      end
+
+      # Matches any of the characters in `separators`
+      #
+      # @return [Regexp, nil]
+      def pattern(separators)
+        unless @pattern_separators.equal?(separators)
+          chars = [separators.component, separators.repetition,
+                   separators.element, separators.segment].select(&:present?)
+          chars = chars.join.split(//).uniq
+
+          @pattern_separators = separators
+          @pattern = chars.empty? ? nil : Regexp.union(chars)
+        end
+
+        @pattern
+      end
     end
   end
 end
@@ -0,0 +1,250 @@
+# frozen_string_literal: true
+require "json"
+
+module Stupidedi
+  using Refinements
+
+  module Writer
+    #
+    # Writes each transaction set as one line of JSON (NDJSON), directly to
+    # an `IO` through a {Buffer}, without building a `Hash` for the tree.
+    # Each line looks like this, with trailing empty elements omitted and
+    # empty elements written as `null`:
+    #
+    #   {"transaction_set":"835","functional_group":"HP",
+    #    "interchange":{"segment":"ISA","elements":["00",...]},
+    #    "group":{"segment":"GS","elements":["HP",...]},
+    #    "children":[{"table":"1 - Header","children":[
+    #      {"segment":"ST","elements":["835","0001"]},
+    #      {"loop":"1000A PAYER IDENTIFICATION","children":[...]}, ...]}, ...]}
+    #
+    # Composite elements are written as an array of components, and repeated
+    # elements as an array of occurrences.
+    #
+    # When a projection is given with `:only`, a transaction set only
+    # includes the tables, loops, and segments that are named in the list,
+    # along with the tables and loops that contain them. Loops and tables
+    # are named by their full identifier, like "2100 CLAIM PAYMENT
+    # INFORMATION", or the first word of it, like "2100". The envelope
+    # segments are always written.
+    #
+    # @example
+    #   writer = Stupidedi::Writer::Json.new($stdout, :only => %w(2100 BPR))
+    #
+    #   parser.each_transaction_set(reader) do |zipper|
+    #     writer.write(zipper)
+    #   end
+    #
+    #   writer.flush
+    #
+    class Json
+      # @return [Array<String>, nil]
+      attr_reader :only
+
+      def initialize(io, options = {})
+        @out  = io.is_a?(Buffer) ? io : Buffer.new(io)
+        @only = options[:only].try{|only| only.map(&:to_s) }
+      end
+
+      # Writes a line for each transaction set at or below `zipper`
+      #
+      # @param zipper [Zipper::AbstractCursor]
+      # @return [Json]
+      def write(zipper)
+        if zipper.node.transaction_set?
+          interchange = zipper.up.up.node unless zipper.root? or zipper.up.root?
+          group       = zipper.up.node unless zipper.root?
+          transaction_set(zipper.node, interchange, group)
+        else
+          envelope(zipper.node, nil, nil)
+        end
+
+        self
+      end
+
+      # @return [Json]
+      def flush
+        @out.flush
+        self
+      end
+
+    private
+
+      # @return [void]
+      def envelope(value, interchange, group)
+        return if value.invalid? or value.segment?
+
+        interchange = value if value.interchange?
+        group       = value if value.functional_group?
+
+        value.children.each do |child|
+          if child.transaction_set?
+            transaction_set(child, interchange, group)
+          elsif not child.segment?
+            envelope(child, interchange, group)
+          end
+        end
+      end
+
+      # @return [void]
+      def transaction_set(value, interchange, group)
+        @out << '{"transaction_set":' << string(value.definition.id)
+        @out << ',"functional_group":' << string(value.definition.functional_group)
+
+        header(interchange, "interchange")
+        header(group, "group")
+
+        @out << ',"children":['
+        @frames = [[nil, true, 0]]
+        value.children.each{|c| node(c) }
+        @out << "]}\n"
+      end
+
+      # Writes the first segment of an interchange or functional group
+      #
+      # @return [void]
+      def header(value, key)
+        segment = value.try{|v| v.children.first }
+        return unless segment.try(:segment?)
+
+        @out << ',"' << key << '":'
+        segment(segment)
+      end
+
+      # Writes `value` if it's named in the projection, or otherwise the
+      # children of `value` that are
+      #
+      # @return [void]
+      def node(value)
+        if value.segment?
+          emit(value) if projected?(value.id.to_s)
+        elsif projected?(value.definition.id)
+          emit(value)
+        else
+          @frames << [group(value), false, 0]
+          value.children.each{|c| node(c) }
+          _, opened, = @frames.pop
+          @out << "]}" if opened
+        end
+      end
+
+      # Writes `value` and its descendants, after opening any enclosing
+      # tables and loops that haven't been written yet
+      #
+      # @return [void]
+      def emit(value)
+        @frames.each_with_index do |frame, n|
+          next if frame[1]
+
+          parent = @frames.at(n - 1)
+          @out << "," unless parent[2].zero?
+          @out << frame[0]
+          parent[2] += 1
+          frame[1]   = true
+        end
+
+        @out << "," unless @frames.last[2].zero?
+        @frames.last[2] += 1
+        tree(value)
+      end
+
+      # @return [void]
+      def tree(value)
+        if value.segment?
+          segment(value)
+        else
+          @out << group(value)
+          value.children.each_with_index do |c, n|
+            @out << "," unless n.zero?
+            tree(c)
+          end
+          @out << "]}"
+        end
+      end
+
+      # The beginning of a table or loop, up to its children
+      #
+      # @return [String]
+      def group(value)
+        key = value.table? ? '{"table":' : '{"loop":'
+        "#{key}#{string(value.definition.id)},\"children\":["
+      end
+
+      # @return [void]
+      def segment(value)
+        @out << '{"segment":' << string(value.id.to_s)
+
+        if value.invalid?
+          @out << ',"invalid":' << string(value.reason) << "}"
+        else
+          @out << ',"elements":'
+          list(value.children){|e| element(e) }
+          @out << "}"
+        end
+      end
+
+      # @return [void]
+      def element(value)
+        if value.simple?
+          simple(value)
+        elsif value.composite?
+          list(value.children){|c| simple(c) }
+        elsif value.repeated?
+          list(value.children){|o| element(o) }
+        end
+      end
+
+      # Writes a JSON array of the values, without the trailing empty ones
+      #
+      # @return [void]
+      def list(values)
+        last = values.rindex{|v| not v.empty? }
+        @out << "["
+
+        0.upto(last || -1) do |n|
+          @out << "," unless n.zero?
+          yield values.at(n)
+        end
+
+        @out << "]"
+      end
+
+      # @return [void]
+      def simple(value)
+        if value.invalid?
+          @out << string(value.value.to_s)
+        elsif value.empty?
+          @out << "null"
+        else
+          @out << string(value.to_x12)
+        end
+      end
+
+      # @return [String]
+      def string(value)
+        return "null" if value.nil?
+        value = utf8(value) unless value.ascii_only?
+
+        if value =~ /["\\\u0000-\u001f]/
+          value.to_json
+        else
+          "\"#{value}\""
+        end
+      end
+
+      # Input that's read in binary mode is assumed to be UTF-8, or
+      # ISO-8859-1 when it isn't valid UTF-8
+      #
+      # @return [String]
+      def utf8(value)
+        utf8 = value.dup.force_encoding(Encoding::UTF_8)
+        utf8.valid_encoding? ? utf8 : value.dup.force_encoding(Encoding::ISO_8859_1).encode(Encoding::UTF_8)
+      end
+
+      # @return [Boolean]
+      def projected?(id)
+        @only.nil? or @only.include?(id) or @only.include?(id.split(" ", 2).first)
+      end
+    end
+  end
+end
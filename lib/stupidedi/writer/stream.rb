@@ -0,0 +1,150 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Writer
+    #
+    # Writes transaction sets as they're yielded by
+    # {Parser::StateMachine#each_transaction_set}, along with the envelope
+    # segments that come before each one, so the input doesn't need to be
+    # parsed entirely before it's written. The output is the same as
+    # {Default} would write for the whole parse tree.
+    #
+    # The position of each open envelope (the transmission, the current
+    # interchange, and its current functional group) is remembered along
+    # with how many of its children were written, so earlier envelopes
+    # aren't visited again. Transaction sets that have been written are
+    # remembered without keeping them from being collected. A transaction
+    # set that wasn't yielded, like one without an SE segment, is written
+    # before the next one that is. Call {#finish} with the
+    # {Parser::StateMachine} that's returned by the parser to write the
+    # trailers, and any transaction sets that weren't yielded.
+    #
+    # @example
+    #   writer = Stupidedi::Writer::Stream.new(io, separators)
+    #
+    #   machine, = parser.each_transaction_set(reader) do |zipper|
+    #     writer.write(zipper)
+    #   end
+    #
+    #   writer.finish(machine.zipper.fetch)
+    #
+    class Stream < Default
+      # An envelope that's been partly written: its position among its
+      # parent's children, the position of the next child to visit and the
+      # child before it, how many of its segments were written, and the
+      # separators for its children and whether elements are checked for them
+      #
+      # @private
+      Open = Struct.new(:position, :resume, :last, :segments, :separators, :check)
+
+      def initialize(io, separators = Reader::Separators.empty)
+        super(nil, separators)
+        @out   = io.is_a?(Buffer) ? io : Buffer.new(io)
+        @open  = []
+        @sets  = ObjectSpace::WeakMap.new
+        @check = false
+      end
+
+      # Writes the transaction set at `zipper`, after any envelope segments
+      # and transaction sets before it that haven't been written yet
+      #
+      # @param zipper [Zipper::AbstractCursor]
+      # @return [Stream]
+      def write(zipper)
+        unless @sets.key?(zipper.node)
+          envelope(zipper.root.node, @separators, 0, 0, zipper.node)
+        end
+
+        self
+      end
+
+      # Writes the envelope segments and transaction sets in the tree that
+      # haven't been written yet, then flushes the output
+      #
+      # @param zipper [Zipper::AbstractCursor]
+      # @return [Stream]
+      def finish(zipper)
+        envelope(zipper.root.node, @separators, 0, 0, nil)
+        flush
+      end
+
+      # @return [Stream]
+      def flush
+        @out.flush
+        self
+      end
+
+    private
+
+      # Writes the children of a transmission, interchange, or functional
+      # group that haven't been written yet, up to and including the
+      # transaction set `target`, or all of them when `target` is nil.
+      # `depth` and `position` locate the envelope among the open ones.
+      #
+      # @return [Boolean] true when `target` was reached
+      def envelope(value, separators, depth, position, target)
+        return false if value.invalid?
+
+        open = @open.at(depth)
+
+        if open.nil? or open.position != position
+          # The envelope that was open at this depth was finished
+          @open.slice!(depth..-1)
+          open = @open[depth] = Open.new(position, 0, nil, 0, separators, @check)
+        end
+
+        if value.interchange? and open.resume.zero?
+          value, open.separators, open.check = interchange(value, separators)
+        end
+
+        children = value.children
+        resume   = open.resume
+        n, skip  = resume, 0
+        found    = false
+        @check   = open.check
+
+        # Transaction sets that were yielded are removed from the parse tree,
+        # so when the last child that was visited has moved, start over and
+        # skip the segments and transaction sets that were written. Nested
+        # envelopes aren't removed, so those before `resume` were finished.
+        unless n.zero? or children.at(n - 1).equal?(open.last)
+          n, skip = 0, open.segments
+        end
+
+        while n < children.length
+          child = children.at(n)
+
+          if child.transaction_set?
+            unless @sets.key?(child)
+              recurse(child, open.separators, @out)
+              @sets[child] = true
+            end
+
+            found = child.equal?(target)
+          elsif child.segment?
+            if skip.zero?
+              recurse(child, open.separators, @out)
+              open.segments += 1
+            else
+              skip -= 1
+            end
+          elsif n < resume
+            # Finished before
+          elsif envelope(child, open.separators, depth + 1, n, target)
+            # The child envelope is still open
+            return true
+          end
+
+          @check      = open.check
+          open.last   = child
+          open.resume = n += 1
+
+          break if found
+        end
+
+        found
+      end
+    end
+  end
+end
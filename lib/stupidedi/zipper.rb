@@ -4,6 +4,7 @@ module Stupidedi
 
   module Zipper
     autoload :AbstractCursor, "stupidedi/zipper/abstract_cursor"
+    autoload :BuilderCursor,  "stupidedi/zipper/builder_cursor"
     autoload :DanglingCursor, "stupidedi/zipper/dangling_cursor"
     autoload :EditedCursor,   "stupidedi/zipper/edited_cursor"
     autoload :MemoizedCursor, "stupidedi/zipper/memoized_cursor"
@@ -13,6 +14,7 @@ module Stupidedi
     autoload :AbstractPath, "stupidedi/zipper/path"
     autoload :Hole,         "stupidedi/zipper/path"
     autoload :Root,         "stupidedi/zipper/path"
+    autoload :SiblingHole,  "stupidedi/zipper/path"
 
     # @todo
     module Tree
@@ -31,6 +33,38 @@ module Stupidedi
         end
       end
     end
+
+    # Builds trees with {BuilderCursor}, which appends nodes in constant time
+    # rather than time proportional to the number of siblings. This is meant
+    # for building a tree from start to finish, like the parser does, and is
+    # selected with `StateMachine.build(config, Zipper::Builder)`.
+    module Builder
+      class << self
+        def build(node)
+          Zipper::BuilderCursor.new(node, [], 0, [], nil)
+        end
+
+        # Returns a {BuilderCursor} at the same location as `zipper`, so
+        # nodes can be appended after it in constant time. The leftward
+        # siblings are copied once, but the ancestors aren't converted, so
+        # moving {AbstractCursor#up} returns the same kind of cursor as
+        # `zipper` does.
+        #
+        # @return [AbstractCursor]
+        def convert(zipper)
+          case zipper
+          when Zipper::RootCursor
+            build(zipper.node)
+          when Zipper::MemoizedCursor, Zipper::EditedCursor
+            left = zipper.path.left.reverse
+            Zipper::BuilderCursor.new(zipper.node, left, left.length,
+              zipper.path.right, zipper.parent)
+          else
+            zipper
+          end
+        end
+      end
+    end
   end
 
   class << Zipper
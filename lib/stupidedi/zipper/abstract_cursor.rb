@@ -171,10 +171,8 @@ module Stupidedi
               "cannot descend into leaf node"
           end
 
-          head, *tail = @node.children
-
-          MemoizedCursor.new(head,
-            Hole.new([], @path, tail), self)
+          MemoizedCursor.new(node.children.first,
+            SiblingHole.new(node.children, 0, path), self)
         end
       end
 
@@ -249,10 +247,11 @@ module Stupidedi
       # @return [AbstractCursor]
       abstract :up
 
-      # Navigate to the next (rightward) sibling node
+      # Navigate to the next (rightward) sibling node, or when `count` is
+      # given, to the `count`th sibling rightward of this node
       #
       # @return [AbstractCursor]
-      abstract :next
+      abstract :next, :args => %w(count=1)
 
       # Navigate to the previous (leftward) sibling node
       #
@@ -0,0 +1,249 @@
+# frozen_string_literal: true
+module Stupidedi
+  using Refinements
+
+  module Zipper
+    #
+    # A cursor that appends siblings to a mutable `Array` instead of copying
+    # the list of leftward siblings, which {EditedCursor} does for each edit.
+    # This makes building a tree one node at a time, like the parser does,
+    # take time and space proportional to the number of nodes.
+    #
+    # Each cursor only "owns" the first `count` elements of the shared array,
+    # so it behaves like a persistent cursor: when the array has already been
+    # extended by another cursor, like another branch of a non-deterministic
+    # parse, the owned elements are copied to a new array first. The nodes
+    # themselves are never modified, and {#up} rebuilds the parent node with
+    # `copy` as usual, so the finished tree is made of the normal node types.
+    #
+    class BuilderCursor < AbstractCursor
+      # (see AbstractCursor#node)
+      attr_reader :node
+
+      # @private
+      # @return [BuilderCursor]
+      attr_reader :parent
+
+      def initialize(node, left, count, right, parent)
+        @node, @left, @count, @right, @parent =
+          node, left, count, right, parent
+      end
+
+      # (see AbstractCursor#path)
+      # @return [AbstractPath]
+      def path
+        @__path ||= begin
+          if root?
+            Root
+          else
+            Hole.new(@left.take(@count).reverse!, @parent.path, @right)
+          end
+        end
+      end
+
+      # @group Querying the Tree Location
+      #########################################################################
+
+      # (see AbstractCursor#depth)
+      def depth
+        root? ? 0 : @parent.depth + 1
+      end
+
+      # (see AbstractCursor#first?)
+      def first?
+        @count.zero?
+      end
+
+      # (see AbstractCursor#last?)
+      def last?
+        @right.empty?
+      end
+
+      # (see AbstractCursor#leaf?)
+      def leaf?
+        @node.leaf? or @node.children.empty?
+      end
+
+      # (see AbstractCursor#root?)
+      def root?
+        @parent.nil?
+      end
+
+      # @group Traversing the Tree
+      #########################################################################
+
+      # (see AbstractCursor#up)
+      # @return [BuilderCursor]
+      def up
+        if root?
+          raise Exceptions::ZipperError,
+            "root node has no parent"
+        end
+
+        @parent.replace(@parent.node.copy(:children =>
+          @left.take(@count).push(@node).concat(@right)))
+      end
+
+      # (see AbstractCursor#next)
+      # @return [BuilderCursor]
+      def next(count = 1)
+        if count > @right.length
+          raise Exceptions::ZipperError,
+            "cannot move to next after last node"
+        end
+
+        left = extend_left
+        left.concat(@right.take(count - 1)) if count > 1
+
+        BuilderCursor.new(@right.at(count - 1), left, @count + count,
+          @right.drop(count), @parent)
+      end
+
+      # (see AbstractCursor#prev)
+      # @return [BuilderCursor]
+      def prev
+        if first?
+          raise Exceptions::ZipperError,
+            "cannot move to prev before first node"
+        end
+
+        BuilderCursor.new(@left.at(@count - 1), @left, @count - 1,
+          @node.cons(@right), @parent)
+      end
+
+      # (see AbstractCursor#first)
+      # @return [BuilderCursor]
+      def first
+        if first?
+          return self
+        end
+
+        right = @left.slice(1, @count - 1).push(@node).concat(@right)
+        BuilderCursor.new(@left.head, @left, 0, right, @parent)
+      end
+
+      # (see AbstractCursor#last)
+      # @return [BuilderCursor]
+      def last
+        if last?
+          return self
+        end
+
+        left = @left.take(@count).push(@node).concat(@right.init)
+        BuilderCursor.new(@right.last, left, left.length, [], @parent)
+      end
+
+      # (see AbstractCursor#dangle)
+      # @return [AbstractCursor]
+      def dangle
+        if @node.leaf?
+          raise Exceptions::ZipperError,
+            "cannot descend into leaf node"
+        end
+
+        if leaf?
+          DanglingCursor.new(self)
+        else
+          head = @node.children.first
+          tail = @node.children.tail
+          BuilderCursor.new(head, [], 0, tail, self)
+        end
+      end
+
+      # @group Editing the Tree
+      #########################################################################
+
+      # (see AbstractCursor#append)
+      # @return [BuilderCursor]
+      def append(node)
+        if root?
+          raise Exceptions::ZipperError,
+            "root node has no siblings"
+        end
+
+        BuilderCursor.new(node, extend_left, @count + 1, @right, @parent)
+      end
+
+      # (see AbstractCursor#prepend)
+      # @return [BuilderCursor]
+      def prepend(node)
+        if root?
+          raise Exceptions::ZipperError,
+            "root node has no siblings"
+        end
+
+        BuilderCursor.new(node, @left, @count, @node.cons(@right), @parent)
+      end
+
+      # (see AbstractCursor#append_child)
+      # @return [BuilderCursor]
+      def append_child(child)
+        if @node.leaf?
+          raise Exceptions::ZipperError,
+            "cannot add child to leaf node"
+        end
+
+        BuilderCursor.new(child, @node.children.dup,
+          @node.children.length, [], self)
+      end
+
+      # (see AbstractCursor#prepend_child)
+      # @return [BuilderCursor]
+      def prepend_child(child)
+        if @node.leaf?
+          raise Exceptions::ZipperError,
+            "cannot add child to leaf node"
+        end
+
+        BuilderCursor.new(child, [], 0, @node.children, self)
+      end
+
+      # (see AbstractCursor#replace)
+      # @return [BuilderCursor]
+      def replace(node)
+        BuilderCursor.new(node, @left, @count, @right, @parent)
+      end
+
+      # (see AbstractCursor#delete)
+      # @return [AbstractCursor]
+      def delete
+        if root?
+          raise Exceptions::ZipperError,
+            "cannot delete root node"
+        end
+
+        if not last?
+          # Move to `next`
+          head = @right.first
+          tail = @right.tail
+          BuilderCursor.new(head, @left, @count, tail, @parent)
+        elsif not first?
+          # Move to `prev`
+          BuilderCursor.new(@left.at(@count - 1), @left, @count - 1, @right, @parent)
+        else
+          # Deleting the only child
+          DanglingCursor.new(@parent.replace(@parent.node.copy(:children => [])))
+        end
+      end
+
+      # @endgroup
+      #########################################################################
+
+    private
+
+      # Returns an array whose first `@count + 1` elements are the leftward
+      # siblings of the next node: those of this node, followed by this node.
+      # The shared array is extended in place if no other cursor has already
+      # extended it.
+      #
+      # @return [Array]
+      def extend_left
+        if @left.length == @count
+          @left << @node
+        else
+          @left.take(@count) << @node
+        end
+      end
+    end
+  end
+end
@@ -59,7 +59,7 @@ module Stupidedi
       end
 
       # (see AbstractCursor#next)
-      def next
+      def next(count = 1)
         raise Exceptions::ZipperError,
           "cannot move to next after last node"
       end
@@ -50,16 +50,17 @@ module Stupidedi
 
       # (see AbstractCursor#next)
       # @return [EditedCursor]
-      def next
-        if last?
+      def next(count = 1)
+        if count > @path.right.length
           raise Exceptions::ZipperError,
             "cannot move to next after last node"
         end
 
-        head, *tail = @path.right
+        skipped = @path.right.take(count - 1).reverse!
 
-        EditedCursor.new(head,
-          Hole.new(@node.cons(@path.left), @path.parent, tail), @parent)
+        EditedCursor.new(@path.right.at(count - 1),
+          Hole.new(skipped.push(@node).concat(@path.left), @path.parent,
+                   @path.right.drop(count)), @parent)
       end
 
       # (see AbstractCursor#prev)
@@ -70,7 +71,8 @@ module Stupidedi
             "cannot move to prev before first node"
         end
 
-        head, *tail = @path.left
+        head = @path.left.first
+        tail = @path.left.tail
 
         EditedCursor.new(head,
           Hole.new(tail, @path.parent, @node.cons(@path.right)), @parent)
@@ -130,13 +132,15 @@ module Stupidedi
       def delete
         if not last?
           # Move to `next`
-          head, *tail = @path.right
+          head = @path.right.first
+          tail = @path.right.tail
 
           EditedCursor.new(head,
             Hole.new(@path.left, @path.parent, tail), @parent)
         elsif not first?
           # Move to `prev`
-          head, *tail = @path.left
+          head = @path.left.first
+          tail = @path.left.tail
 
           EditedCursor.new(head,
             Hole.new(tail, @path.parent, @path.right), @parent)
@@ -41,17 +41,23 @@ module Stupidedi
       end
 
       # @return [MemoizedCursor]
-      def next
+      def next(count = 1)
+        if count > 1
+          if @path.position + count >= @path.siblings.length
+            raise Exceptions::ZipperError,
+              "cannot move to next after last node"
+          end
+
+          return sibling(@path.position + count)
+        end
+
         @__next ||= begin
           if last?
             raise Exceptions::ZipperError,
               "cannot move to next after last node"
           end
 
-          head, *tail = @path.right
-
-          MemoizedCursor.new(head,
-            Hole.new(@node.cons(@path.left), @path.parent, tail), @parent)
+          sibling(@path.position + 1)
         end
       end
 
@@ -63,10 +69,7 @@ module Stupidedi
               "cannot move to prev before first node"
           end
 
-          head, *tail = @path.left
-
-          MemoizedCursor.new(head,
-            Hole.new(tail, @path.parent, @node.cons(@path.right)), @parent)
+          sibling(@path.position - 1)
         end
       end
 
@@ -128,6 +131,17 @@ module Stupidedi
 
       # @endgroup
       #########################################################################
+
+    private
+
+      # Memoized cursors are only created by {AbstractCursor#down} and by
+      # moving between siblings, so `@path` is always a {SiblingHole}
+      #
+      # @return [MemoizedCursor]
+      def sibling(position)
+        MemoizedCursor.new(@path.siblings.at(position),
+          SiblingHole.new(@path.siblings, position, @path.parent), @parent)
+      end
     end
   end
 end
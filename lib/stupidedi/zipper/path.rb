@@ -77,7 +77,7 @@ module Stupidedi
       def inspect
         "root"
       end
-    end.new
+    end.new.freeze
 
     class Hole < AbstractPath
       # (see AbstractPath#right)
@@ -119,7 +119,7 @@ module Stupidedi
 
       # @return [String]
       def inspect
-        "#{@parent.inspect}/#{@left.length}"
+        "#{@parent.inspect}/#{position}"
       end
 
       # @return [Boolean]
@@ -128,5 +128,45 @@ module Stupidedi
         position == other.position
       end
     end
+
+    #
+    # A {Hole} in a node's list of children that hasn't been edited, so the
+    # leftward and rightward siblings are contiguous ranges of `siblings`.
+    # This lets {MemoizedCursor} move between siblings without copying them;
+    # the {#left} siblings are only copied when they're needed.
+    #
+    # @private
+    class SiblingHole < Hole
+      # @return [Array<#leaf?, #children, #copy>]
+      attr_reader :siblings
+
+      # (see Hole#position)
+      attr_reader :position
+
+      def initialize(siblings, position, parent)
+        @siblings, @position, @parent =
+          siblings, position, parent
+      end
+
+      # (see AbstractPath#left)
+      def left
+        @left ||= @siblings.take(@position).reverse!
+      end
+
+      # (see AbstractPath#right)
+      def right
+        @right ||= @siblings.drop(@position + 1)
+      end
+
+      # (see AbstractPath#last?)
+      def last?
+        @position + 1 == @siblings.length
+      end
+
+      # (see AbstractPath#first?)
+      def first?
+        @position.zero?
+      end
+    end
   end
 end
@@ -58,7 +58,7 @@ module Stupidedi
 
       # (see AbstractCursor#next)
       # @return [void]
-      def next
+      def next(count = 1)
         raise Exceptions::ZipperError,
           "root node has no siblings"
       end
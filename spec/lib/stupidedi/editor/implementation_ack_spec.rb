@@ -0,0 +1,153 @@
+describe Stupidedi::Editor::ImplementationAck do
+  using Stupidedi::Refinements
+
+  let(:config) do
+    Stupidedi::Config.hipaa.customize do |c|
+      c.editor.register(Stupidedi::Interchanges::FiveOhOne::InterchangeDef) { Stupidedi::Editor::FiveOhOneEd }
+      c.editor.register(Stupidedi::Versions::FiftyTen::FunctionalGroupDef) { Stupidedi::Editor::FiftyTenEd }
+    end
+  end
+
+  let(:parser) { Stupidedi::Parser.build(config) }
+  let(:editor) { Stupidedi::Editor::TransmissionEd.new(config, Time.now) }
+
+  let(:separators) do
+    Stupidedi::Reader::Separators.build(:segment => "~", :element => "*",
+      :component => ":", :repetition => "^")
+  end
+
+  let(:isa) { Fixtures.envelopes.at(0) }
+  let(:gs)  { Fixtures.envelopes.at(1) }
+
+  # Each transaction set is missing a PER segment. The second has the wrong
+  # segment count in SE01, and the third is missing a required element
+  let(:sets) do
+    [Fixtures.transaction_set("0001"),
+     Fixtures.transaction_set("0002").sub(/^SE\*\d+/, "SE*99"),
+     Fixtures.transaction_set("0003").sub("CLP*5554555444*1*", "CLP*5554555444**")]
+  end
+
+  def acknowledge(input)
+    out = String.new
+    ack = Stupidedi::Editor::ImplementationAck.new(out, separators)
+
+    machine, _, acc = editor.each_transaction_set(parser,
+      Stupidedi::Reader.build(input), :retain => false) do |zipper, results|
+      ack.write(zipper, results)
+    end
+
+    ack.finish(machine.zipper.fetch)
+    expect(acc.results).to be_empty
+
+    return out, ack
+  end
+
+  it "writes a response for each transaction set" do
+    out, ack = acknowledge(Fixtures.transmission(*sets))
+
+    expect(ack.count).to be == 1
+    expect(out.split("~")).to be == [
+      "ST*999*0001*005010X231A1",
+      "AK1*HP*1*005010X221",
+      "AK2*835*0001",
+      "IK3*PER*7*1000*3",
+      "IK5*R*5",
+      "AK2*835*0002",
+      "IK3*PER*7*1000*3",
+      "IK5*R*4*5",
+      "AK2*835*0003",
+      "IK3*PER*7*1000*3",
+      "IK3*CLP*11*2100*8",
+      "IK4*2*1029*1",
+      "IK5*R*5",
+      "AK9*R*3*3*0",
+      "SE*15*0001"]
+  end
+
+  it "writes a transaction set for each functional group" do
+    input = [isa, gs, sets[0], "GE*1*1~",
+                  gs.sub("*1*X*", "*2*X*"), sets[1], "GE*2*3~", "IEA*2*000000905~"].join("\n")
+
+    out, ack = acknowledge(input)
+
+    expect(ack.count).to be == 2
+    expect(out.split("~").grep(/^(ST|AK1|AK9|SE)\*/)).to be == [
+      "ST*999*0001*005010X231A1",
+      "AK1*HP*1*005010X221",
+      "AK9*R*1*1*0",
+      "SE*7*0001",
+      "ST*999*0002*005010X231A1",
+      "AK1*HP*2*005010X221",
+      "AK9*R*2*1*0*5*4",
+      "SE*7*0002"]
+  end
+
+  it "writes a transaction set for functional groups without transaction sets" do
+    input = [isa, gs, "GE*0*1~",
+                  gs.sub("*1*X*", "*2*X*"), sets[0], "GE*1*2~",
+                  gs.sub("*1*X*", "*3*X*"), "GE*0*3~", "IEA*3*000000905~"].join("\n")
+
+    out, ack = acknowledge(input)
+
+    expect(ack.count).to be == 3
+    expect(out.split("~").grep(/^(ST|AK1|AK2|AK9|SE)\*/)).to be == [
+      "ST*999*0001*005010X231A1",
+      "AK1*HP*1*005010X221",
+      "AK9*A*0*0*0",
+      "SE*4*0001",
+      "ST*999*0002*005010X231A1",
+      "AK1*HP*2*005010X221",
+      "AK2*835*0001",
+      "AK9*R*1*1*0",
+      "SE*7*0002",
+      "ST*999*0003*005010X231A1",
+      "AK1*HP*3*005010X221",
+      "AK9*A*0*0*0",
+      "SE*4*0003"]
+  end
+
+  it "rejects transaction sets without an SE segment" do
+    input = [isa, gs, sets[0].sub(/^SE.*?~/, ""), sets[1], sets[2].sub(/^SE.*?~/, ""),
+             "GE*3*1~", "IEA*1*000000905~"].join("\n")
+
+    out, = acknowledge(input)
+
+    expect(out.split("~").grep(/^(AK2|IK5|AK9)\*/)).to be == [
+      "AK2*835*0001",
+      "IK5*R*2",
+      "AK2*835*0002",
+      "IK5*R*4*5",
+      "AK2*835*0003",
+      "IK5*R*2",
+      "AK9*R*3*3*0"]
+  end
+
+  it "accepts transaction sets without errors" do
+    input = Fixtures.read("005010/X221A1 HP835 Health Care Claim Payment Advice/pass/era-sample.edi")
+    out,  = acknowledge(input)
+
+    expect(out.split("~").grep(/^(IK5|AK9)\*/)).to be == ["IK5*A", "AK9*A*1*1*1"]
+  end
+
+  it "writes an acknowledgement that can be parsed" do
+    out, ack = acknowledge(Fixtures.transmission(*sets))
+
+    input = [isa,
+             "GS*FA*RECEIVER*SENDER*20200101*1200*1*X*005010X231A1~",
+             out, "GE*#{ack.count}*1~", "IEA*1*000000905~"].join
+
+    machine, result = parser.read(Stupidedi::Reader.build(input))
+    expect(result).not_to be_fatal
+    expect(machine).to be_deterministic
+    expect(editor.critique(machine).results.select(&:error?)).to be_empty
+  end
+
+  it "rejects data that contains a separator" do
+    # GS08 is copied to AK1, and it contains an "X"
+    ack = Stupidedi::Editor::ImplementationAck.new(String.new, separators.copy(:element => "X"))
+    input = Fixtures.transmission(*sets)
+
+    expect{ editor.each_transaction_set(parser, Stupidedi::Reader.build(input)){|z, acc| ack.write(z, acc) } }.to \
+      raise_error(Stupidedi::Exceptions::OutputError)
+  end
+end
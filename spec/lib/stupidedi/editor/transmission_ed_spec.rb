@@ -0,0 +1,78 @@
+describe Stupidedi::Editor::TransmissionEd do
+  using Stupidedi::Refinements
+
+  let(:config) do
+    Stupidedi::Config.hipaa.customize do |c|
+      c.editor.register(Stupidedi::Interchanges::FiveOhOne::InterchangeDef) { Stupidedi::Editor::FiveOhOneEd }
+      c.editor.register(Stupidedi::Versions::FiftyTen::FunctionalGroupDef) { Stupidedi::Editor::FiftyTenEd }
+    end
+  end
+
+  let(:parser) { Stupidedi::Parser.build(config) }
+  let(:editor) { Stupidedi::Editor::TransmissionEd.new(config, Time.now) }
+
+  # Repeats the transaction set, which is missing a PER segment, three
+  # times. The second has the wrong segment count in SE01, and the third is
+  # missing a required element
+  let(:input) do
+    Fixtures.transmission(Fixtures.transaction_set("0001"),
+      Fixtures.transaction_set("0002").sub(/^SE\*\d+/, "SE*99"),
+      Fixtures.transaction_set("0003").sub("CLP*5554555444*1*", "CLP*5554555444**"))
+  end
+
+  def key(result)
+    [result.class, result.zipper.node.position.offset, result.reason]
+  end
+
+  describe "#each_transaction_set" do
+    it "critiques each transaction set as it's read" do
+      yielded = []
+
+      editor.each_transaction_set(parser, Stupidedi::Reader.build(input)) do |zipper, acc|
+        yielded << [zipper.node.children.first.children.first.element(2).to_s, acc.results.map(&:reason)]
+      end
+
+      expect(yielded).to be == [
+        ["0001", ["missing PER segment"]],
+        ["0002", ["missing PER segment", "must equal the transaction segment count"]],
+        ["0003", ["missing PER segment", "must be present"]]]
+    end
+
+    it "finds the same errors as #critique" do
+      machine, = parser.read(Stupidedi::Reader.build(input))
+      expected = editor.critique(machine).results.map{|r| key(r) }
+      _, _, acc = editor.each_transaction_set(parser, Stupidedi::Reader.build(input))
+
+      expect(acc.results.length).to be == 5
+      expect(acc.results.map{|r| key(r) } - expected).to be_empty
+    end
+
+    it "doesn't critique transaction sets when the interchange has no editor" do
+      # Like #critique, the functional group editor isn't used unless there
+      # is an editor for the interchange version too
+      partial = Stupidedi::Config.hipaa.customize do |c|
+        c.editor.register(Stupidedi::Versions::FiftyTen::FunctionalGroupDef) { Stupidedi::Editor::FiftyTenEd }
+      end
+
+      editor   = Stupidedi::Editor::TransmissionEd.new(partial, Time.now)
+      machine, = parser.read(Stupidedi::Reader.build(input))
+      _, _, acc = editor.each_transaction_set(parser, Stupidedi::Reader.build(input))
+
+      expect(editor.critique(machine).results).to be_empty
+      expect(acc.results).to be_empty
+    end
+
+    it "uses a pool of workers" do
+      _, _, expected = editor.each_transaction_set(parser, Stupidedi::Reader.build(input))
+      order          = []
+
+      _, result, acc = editor.each_transaction_set(parser, Stupidedi::Reader.build(input), :workers => 3) do |zipper, _|
+        order << zipper.node.children.first.children.first.element(2).to_s
+      end
+
+      expect(result).not_to be_fatal
+      expect(order).to be == %w(0001 0002 0003)
+      expect(acc.results.map{|r| key(r) }).to be == expected.results.map{|r| key(r) }
+    end
+  end
+end
@@ -1,3 +1,5 @@
+require "stringio"
+
 describe Stupidedi::Parser::BuilderDsl, "strict validation" do
   using Stupidedi::Refinements
   include Definitions
@@ -1497,3 +1499,85 @@ describe Stupidedi::Parser::BuilderDsl, "strict validation" do
     end
   end
 end
+
+describe Stupidedi::Parser::BuilderDsl, ".stream" do
+  using Stupidedi::Refinements
+
+  let(:config)     { Stupidedi::Config.hipaa }
+  let(:separators) { Stupidedi::Reader::Separators.build(:segment => "~\n", :element => "*", :component => ":", :repetition => "^") }
+  let(:time)       { Time.utc(2020, 1, 2, 3, 4, 5) }
+
+  # Builds an interchange with `count` institutional claims
+  def generate(b, count)
+    stack = Stupidedi::Parser::IdentifierStack.new(1)
+
+    b.ISA("00", "", "00", "", "ZZ", "SUBMITTER ID", "ZZ", "RECEIVER ID", time, time, "^", "00501", stack.isa, "0", "T", ":")
+    b. GS("HC", "SENDER ID", "RECEIVER ID", time, time, stack.gs, b.default, "005010")
+
+    count.times do
+      b. ST("837", stack.st, "005010X223A2")
+      b.BHT("0019", "00", "X"*30, "19990531", time, "CH")
+      b.NM1("41", "1", "SUBMITTER NAME", "", "", "", "", "46", "12EEER000TY")
+      b.PER(b.default, b.blank, "TE", "7607067425")
+      b.NM1("40", "2", "RECEIVER NAME", "", "", "", "", "46", "IDENTIFICATION")
+      b. HL(stack.hl, b.not_used, "20", b.default)
+      b.NM1("85", b.default, "BILLING PROVIDER")
+      b. N3("123 SESAME STREET")
+      b. N4("NEW YORK CITY")
+      b.REF(b.default, "TAX IDENTIFIER")
+      b. HL(stack.hl, stack.parent_hl, "22", "0")
+      b.SBR("P")
+      b.NM1("IL", "2", "SUBSCRIBER NAME", nil, nil, nil, nil, "MI", "MEMBER ID")
+      b. N4("NEW YORK CITY")
+      b.NM1("PR", b.default, "PAYER NAME", nil, nil, nil, nil, "PI", "PAYER ID")
+      b. N4("NEW YORK CITY")
+      b.CLM("CLAIM ID", 7500, nil, nil, b.composite("1", b.default, "1"), nil, "A", "Y", "I")
+      b.DTP("434", "RD8", "20000101-20000102")
+      b.CL1("3", nil, "21")
+      b. HI(b.composite("BK", "277.0"))
+      b. LX(1)
+      b.SV2("0242", b.composite("HC", "30713"), 2500, "UN", 2)
+      stack.pop_hl
+      stack.pop_hl
+      b. SE(stack.count(b), stack.pop_st)
+    end
+
+    b. GE(stack.count, stack.pop_gs)
+    b.IEA(stack.count, stack.pop_isa)
+  end
+
+  def build(count)
+    b = Stupidedi::Parser::BuilderDsl.build(config)
+    generate(b, count)
+    Stupidedi::Writer::Default.new(b.zipper.fetch.root, separators).write
+  end
+
+  it "writes the same output as BuilderDsl.build" do
+    [false, true].each do |strict|
+      output = StringIO.new
+      b = Stupidedi::Parser::BuilderDsl.stream(config, output, separators, strict)
+      generate(b, 3)
+      b.finish
+
+      expect(output.string).to be == build(3)
+    end
+  end
+
+  it "removes each transaction set after writing it" do
+    b = Stupidedi::Parser::BuilderDsl.stream(config, StringIO.new, separators)
+    generate(b, 3)
+
+    expect(b.machine.first.flatmap{|m| m.find(:GS) }.flatmap{|m| m.find(:ST) }).not_to be_defined
+  end
+
+  it "reports the caller's position when a segment is rejected" do
+    b = Stupidedi::Parser::BuilderDsl.stream(config, StringIO.new, separators, true)
+    b.ISA("00", "", "00", "", "ZZ", "SUBMITTER ID", "ZZ", "RECEIVER ID", time, time, "^", "00501", "000000001", "0", "T", ":")
+    b. GS("HC", "SENDER ID", "RECEIVER ID", time, time, 1, b.default, "005010")
+    b. ST("837", "0001", "005010X223A2")
+
+    expect(b.machine.segment.fetch.node.position).to be_nil
+    expect { b.BHT("0019", "00", "X"*30, "19990531", time, "XX") }.to \
+      raise_error(Stupidedi::Exceptions::ParseError, /BHT06 .* at file #{Regexp.escape(__FILE__)}/)
+  end
+end
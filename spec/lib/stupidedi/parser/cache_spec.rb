@@ -0,0 +1,94 @@
+describe Stupidedi::Parser::Cache do
+  using Stupidedi::Refinements
+
+  let(:config) { Stupidedi::Config.hipaa }
+
+  let(:fixture) do
+    Fixtures.read("005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi")
+  end
+
+  def read(input)
+    machine, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+    machine
+  end
+
+  describe ".fetch" do
+    it "evaluates the block once for each key" do
+      table = {}
+      count = 0
+
+      3.times do
+        expect(Stupidedi::Parser::Cache.fetch(table, :key){ count += 1 }).to be == 1
+      end
+
+      expect(count).to be == 1
+    end
+
+    it "evaluates the block once when called from several threads" do
+      table = {}
+      count = Queue.new
+
+      threads = 4.times.map do
+        Thread.new do
+          Stupidedi::Parser::Cache.fetch(table, :key){ count << 1; sleep 0.01; Object.new }
+        end
+      end
+
+      expect(threads.map(&:value).uniq.length).to be == 1
+      expect(count.length).to be == 1
+    end
+  end
+
+  describe ".table" do
+    it "returns the same table for the same owner" do
+      owner = Object.new
+      expect(Stupidedi::Parser::Cache.table(owner)).to equal(
+        Stupidedi::Parser::Cache.table(owner))
+    end
+  end
+
+  describe ".clear" do
+    it "removes the process-wide tables" do
+      owner = Object.new
+      table = Stupidedi::Parser::Cache.table(owner)
+
+      Stupidedi::Parser::Cache.clear
+      expect(Stupidedi::Parser::Cache.table(owner)).not_to equal(table)
+    end
+
+    it "computes the instructions again for new parsers" do
+      a = read(fixture)
+      Stupidedi::Parser::Cache.clear
+      b = read(fixture)
+
+      expect(b).to be_deterministic
+      expect(b.active.head.node.instructions).not_to equal(a.active.head.node.instructions)
+      expect(b.segment.map{|s| s.node.id }.fetch).to be == :IEA
+    end
+  end
+
+  context "when parsing with several parsers" do
+    it "shares instruction tables between them" do
+      a = read(fixture)
+      b = read(fixture)
+
+      expect(a.active.head.node.instructions).to equal(b.active.head.node.instructions)
+      expect(a.active.head.node.instructions.constraints).to equal(
+        b.active.head.node.instructions.constraints)
+    end
+  end
+
+  describe "Parser.precompile" do
+    it "returns the config" do
+      expect(Stupidedi::Parser.precompile(config, "005010X221A1")).to equal(config)
+    end
+
+    it "doesn't change the parse tree" do
+      Stupidedi::Parser.precompile(config, "005010X221A1")
+      machine = read(fixture)
+
+      expect(machine).to be_deterministic
+      expect(machine.segment.map{|s| s.node.id }.fetch).to be == :IEA
+    end
+  end
+end
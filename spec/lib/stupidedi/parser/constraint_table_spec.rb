@@ -0,0 +1,87 @@
+describe Stupidedi::Parser::ConstraintTable::ValueBased do
+  using Stupidedi::Refinements
+
+  let(:d) { Stupidedi::Schema }
+  let(:b) { Stupidedi::TransactionSets::Builder }
+  let(:s) { Stupidedi::TransactionSets::FiftyTen::SegmentDefs }
+  let(:e) { Stupidedi::TransactionSets::FiftyTen::Implementations::ElementReqs }
+  let(:r) { Stupidedi::TransactionSets::FiftyTen::Implementations::SegmentReqs }
+
+  # Neither DTP01 nor DTP02 can tell the three uses apart on its own, but
+  # DTP02 leaves fewer instructions than DTP01
+  let(:segment_uses) do
+    [[%w(096 434), %w(D8)], [%w(096 434), %w(RD8)], [%w(434), %w(D8 RD8)]].map do |dtp01, dtp02|
+      b::Segment(20, s::DTP, "Date", r::Required, d::RepeatCount.bounded(1),
+        b::Element(e::Required, "DTP01", b::Values(*dtp01)),
+        b::Element(e::Required, "DTP02", b::Values(*dtp02)),
+        b::Element(e::Required, "DTP03"))
+    end
+  end
+
+  let(:instructions) do
+    segment_uses.map{|u| Stupidedi::Parser::Instruction.new(nil, u, 0, 0, nil) }
+  end
+
+  let(:table) { Stupidedi::Parser::ConstraintTable.build(instructions) }
+
+  def mksegment_tok(*elements)
+    Stupidedi::Reader::SegmentTok.build(:DTP,
+      elements.map{|x| Stupidedi::Reader::SimpleElementTok.build(x, nil, "") }, nil, "")
+  end
+
+  def matches(*elements)
+    table.matches(mksegment_tok(*elements), false, :insert).map{|i| instructions.index(i) }
+  end
+
+  it "narrows the instructions using the combination of elements" do
+    expect(table).to be_a(Stupidedi::Parser::ConstraintTable::ValueBased)
+
+    expect(matches("096", "D8",  "20240101")).to be == [0]
+    expect(matches("096", "RD8", "20240101-20240131")).to be == [1]
+    expect(matches("434", "D8",  "20240101")).to be == [0, 2]
+    expect(matches("999", "D8",  "20240101")).to be == [0, 2]
+    expect(matches("999", "XX",  "20240101")).to be == []
+  end
+
+  it "orders the distinct elements by how many instructions they leave" do
+    _, distinct, ordered = table.basis(instructions, :insert)
+    expect(distinct.map{|(n, _), _| n }).to be == [0, 1]
+    expect(ordered.map{|(n, _), _| n }).to be == [1, 0]
+  end
+
+  context "when the elements contradict each other" do
+    # DTP03 leaves the fewest instructions, but "096", "D8", and "2" aren't
+    # allowed together by any of these
+    let(:segment_uses) do
+      [[%w(096), %w(D8), %w(1)], [%w(096), %w(RD8), %w(2)], [%w(434), %w(D8), %w(2)],
+       [%w(434), %w(RD8), %w(1 3 4 5 6)]].map do |dtp01, dtp02, dtp03|
+        b::Segment(20, s::DTP, "Date", r::Required, d::RepeatCount.bounded(1),
+          b::Element(e::Required, "DTP01", b::Values(*dtp01)),
+          b::Element(e::Required, "DTP02", b::Values(*dtp02)),
+          b::Element(e::Required, "DTP03", b::Values(*dtp03)))
+      end
+    end
+
+    it "picks the instruction in the order of the elements" do
+      _, _, ordered = table.basis(instructions, :insert)
+      expect(ordered.map{|(n, _), _| n }.first).to be == 2
+
+      expect(matches("096", "D8", "2")).to be == [0]
+      expect(matches("434", "RD8", "2")).to be == [3]
+    end
+  end
+
+  it "memoizes the instructions for each combination of subsets" do
+    a = table.matches(mksegment_tok("434", "D8", "20240101"), false, :insert)
+    b = table.matches(mksegment_tok("434", "D8", "20991231"), false, :insert)
+    c = table.matches(mksegment_tok("434", "RD8", "20991231"), false, :insert)
+
+    expect(b).to equal(a)
+    expect(c).not_to equal(a)
+  end
+
+  it "raises an error for values that aren't allowed in strict mode" do
+    expect{ table.matches(mksegment_tok("999", "D8", "20240101"), true, :insert) }.
+      to raise_error(ArgumentError, /not allowed in element DTP01/)
+  end
+end
@@ -0,0 +1,78 @@
+require "tempfile"
+
+describe Stupidedi::Parser::EnvelopeIndex do
+  using Stupidedi::Refinements
+
+  let(:isa) { Fixtures.envelopes.at(0) }
+  let(:gs)  { Fixtures.envelopes.at(1) }
+  let(:st)  { Fixtures.envelopes.at(2) }
+
+  # Two interchanges with distinct control numbers, the first with two
+  # transaction sets, separated by some text
+  let(:input) do
+    first  = Fixtures.transmission(Fixtures.transaction_set("0001"), Fixtures.transaction_set("0002"))
+    second = [isa.sub("000000905", "000000906"), gs.sub("*1*X*", "*2*X*"),
+              Fixtures.transaction_set("0003"), "GE*1*2~", "IEA*1*000000906~"]
+
+    [first, "not part of an interchange", *second].join("\n")
+  end
+
+  describe ".build" do
+    it "finds each envelope and its control number" do
+      index = Stupidedi::Parser::EnvelopeIndex.build(input)
+
+      expect(index.interchanges.map(&:control_number)).to be == %w(000000905 000000906)
+      expect(index.interchanges.map(&:version)).to be == %w(00501 00501)
+      expect(index.functional_groups.map(&:control_number)).to be == %w(1 2)
+      expect(index.functional_groups.map(&:version)).to be == %w(005010X221 005010X221)
+      expect(index.transaction_sets.map(&:control_number)).to be == %w(0001 0002 0003)
+      expect(index.transaction_sets.map(&:identifier)).to be == %w(835 835 835)
+
+      expect(index.transaction_sets.last.functional_group.interchange).to equal(index.interchanges.last)
+    end
+
+    it "records the byte range of each envelope" do
+      index = Stupidedi::Parser::EnvelopeIndex.build(input)
+
+      index.interchanges.each do |e|
+        expect(input.byteslice(e.offset, e.length)).to match(/\AISA.*IEA\*1\*\d+~\z/m)
+      end
+
+      index.functional_groups.each do |e|
+        expect(input.byteslice(e.offset, e.length)).to match(/\AGS.*GE\*\d\*\d~\z/m)
+      end
+
+      sets = index.transaction_sets.map{|e| input.byteslice(e.offset, e.length) }
+      expect(sets).to be == %w(0001 0002 0003).map{|n| Fixtures.transaction_set(n) }
+    end
+
+    it "reads an IO like a String" do
+      Tempfile.create("envelope-index") do |file|
+        file.write(input)
+        file.flush
+
+        index = Stupidedi::Parser::EnvelopeIndex.build(File.open(file.path, "rb"))
+        expect(index.transaction_sets.map{|e| [e.offset, e.length] }).to be ==
+          Stupidedi::Parser::EnvelopeIndex.build(input).transaction_sets.map{|e| [e.offset, e.length] }
+      end
+    end
+
+    it "finds the separators of each interchange" do
+      other = [isa.tr("*~", "|\n"), gs.tr("*~", "|\n"), st.tr("*~", "|\n"),
+               "GE|1|1\n", "IEA|1|000000905\n"].join
+      index = Stupidedi::Parser::EnvelopeIndex.build(input + "\n" + other)
+
+      expect(index.interchanges.map{|e| e.separators.element }).to be == %w(* * |)
+      expect(index.transaction_sets.length).to be == 4
+      expect(index.transaction_sets.last.length).to be == st.bytesize
+    end
+
+    it "leaves the length of unterminated envelopes nil" do
+      index = Stupidedi::Parser::EnvelopeIndex.build([isa, gs, st].join("\n"))
+
+      expect(index.transaction_sets.head.length).to be == st.bytesize
+      expect(index.functional_groups.head.length).to be_nil
+      expect(index.interchanges.head.length).to be_nil
+    end
+  end
+end
@@ -0,0 +1,260 @@
+require "tempfile"
+
+describe Stupidedi::Parser::Generation do
+  using Stupidedi::Refinements
+
+  let(:config) { Stupidedi::Config.hipaa }
+  let(:parser) { Stupidedi::Parser.build(config) }
+
+  # Repeats the single transaction set in the fixture three times, with
+  # distinct control numbers
+  let(:input) do
+    Fixtures.transmission(*%w(0001 0002 0003).map{|n| Fixtures.transaction_set(n) })
+  end
+
+  def mkreader(input)
+    Stupidedi::Reader.build(input)
+  end
+
+  describe "#read" do
+    it "doesn't change the machine it's called on" do
+      active = parser.active.dup
+      first, = parser.read(mkreader(input))
+      second, = parser.read(mkreader(input))
+
+      expect(parser.active).to be == active
+      expect(parser.active.head.node).to be_a(Stupidedi::Parser::InitialState)
+      expect(first).not_to equal(parser)
+      expect(second.segment.map{|z| z.node.position.offset }.fetch).to be ==
+        first.segment.map{|z| z.node.position.offset }.fetch
+    end
+
+    it "computes lazy positions after an IO is closed" do
+      Tempfile.create("read") do |file|
+        file.write(input)
+        file.flush
+
+        machine, result = File.open(file.path, "rb") do |io|
+          parser.read(Stupidedi::Reader.build(io, :lazy_positions => true))
+        end
+
+        expected, = parser.read(mkreader(input))
+        position  = machine.segment.map{|z| z.node.position }.fetch
+
+        expect(position).to be_a(Stupidedi::Reader::LazyPosition)
+        expect(position.line).to be == expected.segment.map{|z| z.node.position.line }.fetch
+        expect(result.position.inspect).to be_a(String)
+      end
+    end
+  end
+
+  describe "#each_transaction_set" do
+    it "yields each transaction set" do
+      control = []
+
+      parser.each_transaction_set(mkreader(input)) do |zipper|
+        expect(zipper.node).to be_transaction_set
+        expect(zipper.node.children.first.children.first.id).to be == :ST
+
+        control << zipper.node.children.last.children.last.children.at(1).to_s
+      end
+
+      expect(control).to be == %w(0001 0002 0003)
+    end
+
+    it "yields the same transaction sets as #read" do
+      yielded = []
+      parser.each_transaction_set(mkreader(input)){|zipper| yielded << zipper.node }
+
+      machine, = parser.read(mkreader(input))
+      interchange, = machine.zipper.fetch.root.node.children
+      expected = interchange.children.at(1).children.select(&:transaction_set?)
+
+      expect(yielded.length).to be == 3
+      expect(yielded).to be == expected
+    end
+
+    it "yields the enclosing interchange and functional group" do
+      parser.each_transaction_set(mkreader(input)) do |zipper|
+        expect(zipper.up.node.children.first.id).to be == :GS
+        expect(zipper.up.up.node.children.first.id).to be == :ISA
+      end
+    end
+
+    it "yields a machine positioned on the ST segment" do
+      parser.each_transaction_set(mkreader(input)) do |zipper, st|
+        expect(st.segment.map{|z| z.node.id }.fetch).to be == :ST
+        expect(st.parent.flatmap{|gs| gs.segment }.map{|z| z.node.id }.fetch).to be == :GS
+
+        se = st.find(:SE).fetch
+        expect(se.segment.map{|z| z.node.position }.fetch).to be ==
+          zipper.node.children.last.children.last.position
+        expect(st.distance(se).fetch + 1).to be == zipper.node.size
+      end
+    end
+
+    it "removes each transaction set from the parse tree" do
+      machine, = parser.each_transaction_set(mkreader(input)){|_| }
+      expect(machine).to be_deterministic
+
+      interchange, = machine.zipper.fetch.root.node.children
+      expect(interchange.children.map(&:class)).to be ==
+        [Stupidedi::Values::SegmentVal,
+         Stupidedi::Values::FunctionalGroupVal,
+         Stupidedi::Values::SegmentVal]
+
+      group = interchange.children.at(1)
+      expect(group.children.map(&:id)).to be == [:GS, :GE]
+    end
+
+    it "continues parsing after each transaction set" do
+      machine, result = parser.each_transaction_set(mkreader(input)){|_| }
+
+      expect(result).not_to be_fatal
+      expect(machine.segment.map{|z| z.node.id }.fetch).to be == :IEA
+    end
+  end
+
+  describe "#reparse" do
+    let(:machine) { parser.read(mkreader(input)).head }
+
+    # The functional group in the parse tree of `machine`
+    def group(machine)
+      machine.zipper.fetch.root.child(0).child(1)
+    end
+
+    # Changes BPR02 in the `n`th transaction set
+    def edit(machine, n, amount)
+      bpr = group(machine).child(n).down.down.next
+      bpr.replace(bpr.node.copy(:children =>
+        bpr.node.children.dup.tap{|es| es[1] = es[1].copy(:value => amount) }))
+    end
+
+    def signature(machine)
+      segments = []
+      machine  = machine.first
+
+      while machine.defined?
+        machine.flatmap(&:segment).tap do |s|
+          segments << [s.node.id, s.node.usage.try(:position), s.node.children.map do |e|
+            e.composite? ? e.children.map(&:inspect) : e.inspect
+          end]
+        end
+
+        machine = machine.flatmap(&:next)
+      end
+
+      segments
+    end
+
+    it "reads the changed transaction set again" do
+      edited, yielded = edit(machine, 2, "100"), []
+      reparsed = machine.reparse(edited){|_, st| yielded << st.element(2).map{|e| e.node.to_s }.fetch }
+
+      output = Stupidedi::Writer::Default.new(edited.root).write
+      expected, = parser.read(mkreader(output))
+
+      expect(yielded).to be == %w(0002)
+      expect(signature(reparsed)).to be == signature(expected)
+      expect(reparsed.segment.map{|z| z.node.id }.fetch).to be == :IEA
+    end
+
+    it "reuses the transaction sets that weren't changed" do
+      original = group(machine).node.children
+      reparsed = group(machine.reparse(edit(machine, 3, "100"))).node.children
+
+      expect(reparsed.length).to be == original.length
+      expect(reparsed.at(1)).to equal(original.at(1))
+      expect(reparsed.at(2)).to equal(original.at(2))
+      expect(reparsed.at(3)).not_to equal(original.at(3))
+    end
+
+    it "reads everything again when the envelope was changed" do
+      gs, yielded = group(machine).down, []
+      edited = gs.replace(gs.node.copy)
+
+      machine.reparse(edited){|zipper, _| yielded << zipper.node }
+      expect(yielded.length).to be == 3
+    end
+
+    it "reads everything again when a transaction set ends differently" do
+      se, yielded = group(machine).child(1).down.last.down.last, []
+      expect(se.node.id).to be == :SE
+
+      reparsed = machine.reparse(se.delete){|zipper, _| yielded << zipper.node }
+      expect(yielded.length).to be == 3
+      expect(reparsed.segment.map{|z| z.node.id }.fetch).to be == :IEA
+    end
+
+    # These have segments with no elements (ENT, RMR), which the writer
+    # omits, and the FA997 fixture ends segments with a newline
+    [ "005010/X218 RA820 Payroll Deducted and Other Group Premium Payment for Insurance Products/pass/list-bill.edi",
+      "005010/X306 RA820 Health Insurance Exchange Related Payments/pass/final-hix-820-aptc-adjustments.edi",
+      "004010/FA997/pass/1.edi" ].each do |path|
+      it "keeps every segment of #{path.split("/").values_at(0, 1).join(" ")}" do
+        # There are no implementation guides for these, so use the standards
+        _, _, config = Fixtures.passing.find{|p, m, _| p.to_s == path and m =~ /Standards/ }
+        machine, = Fixtures.parse(path, config)
+        group    = machine.zipper.fetch.root.child(0).child(1)
+        edited   = group.child(1)
+        edited   = edited.replace(edited.node.copy).root
+
+        expect(signature(machine.reparse(edited))).to be == signature(machine)
+      end
+    end
+  end
+
+  describe "#read_transaction_set" do
+    let(:index) { Stupidedi::Parser::EnvelopeIndex.build(input) }
+
+    # The identifier and offset of each segment in `machine` that's within
+    # the byte range of `entry`
+    def segments(machine, entry)
+      segments = []
+      machine  = machine.first
+
+      while machine.defined?
+        machine.flatmap(&:segment).tap do |s|
+          offset = s.node.position.offset
+          segments << [s.node.id, offset] if (entry.offset...entry.offset + entry.length).cover?(offset)
+        end
+
+        machine = machine.flatmap(&:next)
+      end
+
+      segments
+    end
+
+    it "reads only the given transaction set" do
+      entry           = index.transaction_sets.at(1)
+      machine, result = parser.read_transaction_set(input, entry)
+
+      expect(result).not_to be_fatal
+      expect(machine).to be_deterministic
+
+      interchange, = machine.zipper.fetch.root.node.children
+      expect(interchange.children.map(&:class)).to be ==
+        [Stupidedi::Values::SegmentVal, Stupidedi::Values::FunctionalGroupVal]
+      expect(interchange.children.at(1).children.map(&:class)).to be ==
+        [Stupidedi::Values::SegmentVal, Stupidedi::Values::TransactionSetVal]
+
+      full, = parser.read(mkreader(input))
+      expect(segments(machine, entry)).to be == segments(full, entry)
+      expect(segments(machine, entry).length).to be == 32
+    end
+
+    it "reads the transaction set from an IO" do
+      Tempfile.create("read-transaction-set") do |file|
+        file.write(input)
+        file.flush
+
+        entry    = index.transaction_sets.at(2)
+        machine, = parser.read_transaction_set(File.open(file.path, "rb"), entry)
+        expected, = parser.read_transaction_set(input, entry)
+
+        expect(segments(machine, entry)).to be == segments(expected, entry)
+        expect(machine.segment.map{|z| z.node.id }.fetch).to be == :SE
+      end
+    end
+  end
+end
@@ -0,0 +1,97 @@
+describe Stupidedi::Parser::Instrumentation do
+  using Stupidedi::Refinements
+
+  let(:input) do
+    Fixtures.read("005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi")
+  end
+
+  let(:instrumentation) { Stupidedi::Parser::Instrumentation.new }
+
+  def read(instrumentation)
+    config = Stupidedi::Config.hipaa.customize{|c| c.instrumentation = instrumentation }
+    machine, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+    machine
+  end
+
+  def segments(value)
+    value.segment? ? [value] : value.children.flat_map{|c| segments(c) }
+  end
+
+  it "isn't used by default" do
+    expect(Stupidedi::Config.new.instrumentation).to be_nil
+  end
+
+  it "counts each phase of parsing" do
+    machine = read(instrumentation)
+    count   = segments(machine.zipper.fetch.root.node).length
+
+    expect(instrumentation.segments).to be == count
+    expect(instrumentation.peak_nondeterminism).to be == 1
+    expect(instrumentation.phases[:tokenize].count).to be == count + 1
+    expect(instrumentation.phases[:match].count).to be == count
+    expect(instrumentation.phases[:execute].count).to be == count
+
+    # Except for the ISA and GS segments
+    expect(instrumentation.phases[:convert].count).to be == count - 2
+
+    instrumentation.phases.each_value do |counter|
+      expect(counter.time).to be > 0
+    end
+  end
+
+  it "counts the segments executed for each segment use" do
+    read(instrumentation)
+    counts = Hash.new(0)
+    instrumentation.segment_uses.each{|use, counter| counts[use.id] += counter.count }
+
+    expect(counts.values.sum).to be == instrumentation.segments
+    expect(counts[:CLP]).to be == 2
+    expect(counts.keys).to include(:ISA, :GS, :ST, :BPR, :SE)
+  end
+
+  describe "#measure" do
+    it "doesn't count the time of nested phases" do
+      instrumentation.measure(:execute) do
+        instrumentation.measure(:convert) { sleep 0.02 }
+        sleep 0.01
+      end
+
+      expect(instrumentation.phases[:convert].time).to be >= 0.02
+      expect(instrumentation.phases[:execute].time).to be >= 0.01
+      expect(instrumentation.phases[:execute].time).to be < 0.02
+    end
+
+    it "returns the value of the block" do
+      expect(instrumentation.measure(:match) { 123 }).to be == 123
+    end
+
+    it "doesn't count the time of phases on other threads as nested" do
+      instrumentation.measure(:execute) do
+        Thread.new { instrumentation.measure(:convert) { sleep 0.02 } }.join
+      end
+
+      expect(instrumentation.phases[:convert].time).to be >= 0.02
+      expect(instrumentation.phases[:execute].time).to be >= 0.02
+    end
+  end
+
+  it "can be shared by parsers on several threads" do
+    count = segments(read(Stupidedi::Parser::Instrumentation.new).zipper.fetch.root.node).length
+    4.times.map { Thread.new { read(instrumentation) } }.each(&:join)
+
+    expect(instrumentation.segments).to be == count * 4
+    expect(instrumentation.phases[:match].count).to be == count * 4
+    expect(instrumentation.phases[:execute].count).to be == count * 4
+    expect(instrumentation.segment_uses.values.sum(&:count)).to be == count * 4
+  end
+
+  describe "#to_h" do
+    it "summarizes the counters" do
+      read(instrumentation)
+
+      expect(instrumentation.to_h.keys).to be == %i(segments peak_nondeterminism tokenize match execute convert)
+      expect(instrumentation.to_h[:match]).to be == instrumentation.phases[:match].to_h
+      expect(instrumentation.reset!.to_h[:segments]).to be == 0
+    end
+  end
+end
@@ -223,6 +223,65 @@ describe Stupidedi::Parser::Navigation do
       end
     end
 
+    context "when the siblings are indexed" do
+      context "and the match is a sibling" do
+        before { stub_const("Stupidedi::Parser::Navigation::INDEX_THRESHOLD", 0) }
+
+        let(:b) do
+          strict(
+            Detail("2",
+              Segment(50, NNA(), s_mandatory, bounded(1)),
+              Segment(60, NNB(), s_mandatory, bounded(1)),
+              Segment(80, IDA(), s_mandatory, unbounded)))
+        end
+
+        let(:m) do
+          b.NNA(0)
+          b.NNB(1)
+          b.IDA("A", "", 1)
+          b.IDA("A", "", 2)
+          b.IDA("B", "", 3)
+          b.IDA("A", "", 4)
+          b.IDA("B", "", 5)
+          b.IDA("B", "", 6)
+          b.machine.first.flatmap{|m| m.sequence(:GS, :ST, :NNA) }.fetch
+        end
+
+        include_examples "123456"
+      end
+
+      context "and the match is in a loop" do
+        let(:config) { Stupidedi::Config.hipaa }
+
+        let(:m) do
+          input = Fixtures.read("005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi")
+          machine, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+          machine.first.flatmap{|m| m.sequence(:GS, :ST, :LX) }.fetch
+        end
+
+        # Lists the offset of each CLP segment, and its NM1*QC segment
+        def claims(m)
+          claims = []
+          m.iterate(:CLP) do |clp|
+            claims << [Stupidedi::Either.success(clp), clp.find(:NM1, "QC")].map do |x|
+              x.flatmap(&:segment).map{|s| s.node.position.offset }.fetch
+            end
+          end
+          claims
+        end
+
+        it "finds the same segments as a linear search" do
+          stub_const("Stupidedi::Parser::Navigation::INDEX_THRESHOLD", Float::INFINITY)
+          expected = claims(m)
+          stub_const("Stupidedi::Parser::Navigation::INDEX_THRESHOLD", 0)
+
+          expect(claims(m)).to be == expected
+          expect(m.count(:CLP)).to be == expected.length
+          expect(expected.length).to be > 1
+        end
+      end
+    end
+
     context "when match is a nephew" do
       context "one level down" do
         context "in an immediately adjacent unqualified loop" do
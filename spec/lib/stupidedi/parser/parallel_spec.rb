@@ -0,0 +1,162 @@
+require "tempfile"
+
+describe Stupidedi::Parser::Parallel do
+  using Stupidedi::Refinements
+
+  let(:config) { Stupidedi::Config.hipaa }
+
+  # The fixture's interchange, repeated three times with distinct control
+  # numbers, and separated by out-of-band text
+  let(:input) do
+    interchange = Fixtures.interchange
+
+    %w(000000001 000000002 000000003).map do |n|
+      "junk\n" + interchange.gsub("000000905", n)
+    end.join("\n") + "\n"
+  end
+
+  def sequential(input)
+    Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+  end
+
+  # Lists the id and position of each segment in the parse tree
+  def segments(machine)
+    segments = []
+    cursor   = machine.first
+
+    while cursor.defined?
+      cursor = cursor.flatmap do |m|
+        m.segment.tap do |s|
+          segments << [s.node.id, s.node.position.offset,
+                       s.node.position.line, s.node.position.column]
+        end
+
+        m.next
+      end
+    end
+
+    segments
+  end
+
+  describe ".partition" do
+    it "divides the input after each IEA segment" do
+      chunks = Stupidedi::Parser::Parallel.partition(
+        Stupidedi::Reader::Input.build(input))
+
+      expect(chunks.length).to be == 3
+      expect(chunks.map{|position, _| position.offset }).to be ==
+        [0, chunks.at(0).last, chunks.at(0).last + chunks.at(1).last]
+      expect(chunks.last.last).to be_nil
+
+      position, length = chunks.at(1)
+      expect(input[position.offset, length]).to match(/\A\njunk\nISA.*IEA\*1\*000000002~\z/m)
+      expect(position.line).to be == input[0, position.offset].count("\n") + 1
+    end
+
+    it "returns one chunk when there are no interchanges" do
+      chunks = Stupidedi::Parser::Parallel.partition(
+        Stupidedi::Reader::Input.build("junk"))
+
+      expect(chunks.length).to be == 1
+      expect(chunks.head.first.offset).to be == 0
+    end
+
+    it "includes an interchange without an IEA segment in the last chunk" do
+      truncated = input.sub(/IEA\*1\*000000003~\n\z/, "")
+      chunks    = Stupidedi::Parser::Parallel.partition(
+        Stupidedi::Reader::Input.build(truncated))
+
+      expect(chunks.length).to be == 2
+
+      position, = chunks.last
+      expect(truncated[position.offset..-1].scan(/^ISA/).length).to be == 2
+    end
+  end
+
+  describe ".read" do
+    it "produces the same parse tree as Generation#read" do
+      machine, result = Stupidedi::Parser::Parallel.read(config, input, :workers => 2, :fork => false)
+      expected, expected_result = sequential(input)
+
+      expect(machine).to be_deterministic
+      expect(segments(machine)).to be == segments(expected)
+      expect(segments(machine).count{|id, *| id == :ISA }).to be == 3
+      expect(result.reason).to be == expected_result.reason
+    end
+
+    it "is positioned on the last segment" do
+      machine, = Stupidedi::Parser::Parallel.read(config, input)
+
+      expect(machine.segment.map{|s| s.node.id }.fetch).to be == :IEA
+      expect(machine.last.flatmap(&:segment).map{|s| s.node.position.offset }.fetch).to be ==
+        machine.segment.map{|s| s.node.position.offset }.fetch
+    end
+
+    it "reads from an IO" do
+      Tempfile.create("parallel") do |file|
+        file.write(input)
+        file.flush
+
+        machine, = Stupidedi::Parser::Parallel.read(config, File.open(file.path, "rb"))
+        expect(segments(machine)).to be == segments(sequential(input).first)
+      end
+    end
+
+    it "accepts input without any interchanges" do
+      machine, result = Stupidedi::Parser::Parallel.read(config, "junk")
+
+      expect(machine).to be_empty
+      expect(result).not_to be_fatal
+    end
+
+    it "rejects fewer than one worker" do
+      expect{ Stupidedi::Parser::Parallel.read(config, input, :workers => 0) }.to \
+        raise_error(ArgumentError)
+    end
+
+    if Process.respond_to?(:fork)
+      it "produces the same parse tree with forked processes" do
+        machine, result = Stupidedi::Parser::Parallel.read(config, input, :workers => 2, :fork => true)
+        expected, expected_result = sequential(input)
+
+        expect(machine).to be_deterministic
+        expect(segments(machine)).to be == segments(expected)
+        expect(result.reason).to be == expected_result.reason
+      end
+    end
+
+    if RUBY_ENGINE == "ruby" and Process.respond_to?(:fork)
+      it "uses forked processes by default on MRI" do
+        expect(Stupidedi::Parser::Snapshot).to receive(:load).at_least(:once).and_call_original
+        Stupidedi::Parser::Parallel.read(config, input, :workers => 2)
+      end
+    end
+  end
+
+  describe ".each_interchange" do
+    it "yields each interchange" do
+      controls = Stupidedi::Parser::Parallel.each_interchange(config, input) do |machine, result|
+        machine.first.flatmap{|m| m.element(13) }.map{|e| e.node.to_s }.fetch
+      end
+
+      expect(controls).to be == %w(1 2 3)
+    end
+
+    it "rejects fewer than one worker" do
+      expect{ Stupidedi::Parser::Parallel.each_interchange(config, input, :workers => 0, :fork => true){} }.to \
+        raise_error(ArgumentError)
+    end
+
+    if Process.respond_to?(:fork)
+      it "yields each interchange in a forked process" do
+        positions = Stupidedi::Parser::Parallel.each_interchange(config, input, :fork => true, :workers => 2) do |machine, _|
+          [Process.pid, machine.first.flatmap(&:segment).map{|s| s.node.position.offset }.fetch]
+        end
+
+        expect(positions.map(&:first)).not_to include(Process.pid)
+        expect(positions.map(&:last)).to be ==
+          segments(sequential(input).first).select{|id, *| id == :ISA }.map{|_, offset, *| offset }
+      end
+    end
+  end
+end
@@ -0,0 +1,66 @@
+describe Stupidedi::Parser::Projection do
+  using Stupidedi::Refinements
+
+  let(:input) do
+    Fixtures.read("005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi")
+  end
+
+  def read(projection)
+    config = Stupidedi::Config.hipaa.customize{|c| c.projection = projection }
+    machine, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+    machine
+  end
+
+  def segments(value)
+    value.segment? ? [value] : value.children.flat_map{|c| segments(c) }
+  end
+
+  def raw(segments)
+    segments.select{|s| s.is_a?(Stupidedi::Values::RawSegmentVal) }
+  end
+
+  let(:eager) { segments(read(nil).zipper.fetch.root.node) }
+
+  it "isn't used by default" do
+    expect(Stupidedi::Config.new.projection).to be_nil
+    expect(raw(eager)).to be_empty
+  end
+
+  it "builds values for the named loops and the loops they contain" do
+    projected = segments(read(%w(2100)).zipper.fetch.root.node)
+    built     = projected.reject{|s| s.is_a?(Stupidedi::Values::RawSegmentVal) }
+
+    expect(built.map(&:id).uniq).to be == %i(ISA GS CLP CAS NM1 REF AMT SVC DTM)
+    expect(raw(projected).map(&:id)).to include(:ST, :BPR, :LX, :SE)
+    expect(raw(projected).all?(&:raw?)).to be == true
+  end
+
+  it "builds values for the named segments" do
+    projected = segments(read(%w(CLP 1\ -\ Header)).zipper.fetch.root.node)
+    built     = projected.reject{|s| s.is_a?(Stupidedi::Values::RawSegmentVal) }
+
+    expect(built.map(&:id)).to include(:ST, :BPR, :CLP)
+    expect(built.map(&:id)).not_to include(:SVC, :LX)
+  end
+
+  it "reads the same tree" do
+    projected = segments(read(%w(SVC)).zipper.fetch.root.node)
+
+    expect(projected.map(&:id)).to be == eager.map(&:id)
+    expect(projected.map{|s| s.position.offset }).to be == eager.map{|s| s.position.offset }
+
+    # Skip the ISA, whose separator elements aren't equal between parses
+    projected.zip(eager).drop(1).each do |p, e|
+      expect(p).to be == e
+      expect(p.children.map(&:class)).to be == e.children.map(&:class)
+    end
+  end
+
+  it "builds the elements of a raw segment when they're used" do
+    machine = read(%w(SVC))
+    clp03   = machine.first.flatmap{|m| m.sequence(:GS, :ST, :LX, :CLP) }.
+      flatmap{|m| m.element(3) }.map(&:node).fetch
+
+    expect(clp03.to_d).to be == BigDecimal("800")
+  end
+end
@@ -0,0 +1,137 @@
+describe Stupidedi::Parser::StateMachine, "scaling" do
+  using Stupidedi::Refinements
+
+  let(:config) { Stupidedi::Config.hipaa }
+
+  def parse(input)
+    Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input)).head
+  end
+
+  # Moves to the first service line (2400) loop of the first claim
+  def first_line(machine)
+    machine.first
+      .flatmap{|m| m.find(:GS) }
+      .flatmap{|m| m.find(:ST) }
+      .flatmap{|m| m.find(:HL) }
+      .flatmap{|m| m.find(:HL) }
+      .flatmap{|m| m.find(:CLM) }
+      .flatmap{|m| m.find(:LX) }
+  end
+
+  describe "#read" do
+    Quickcheck::Scaling.property(self, "grows linearly with the number of HL loops") do
+      shape = { :patients => between(0, 2), :claims => between(1, 2), :lines => between(1, 2) }
+
+      measure([10, 20, 40, 80], lambda{|n| hc837(shape.merge(:subscribers => n)) }) do |input|
+        parse(input)
+      end
+    end.check(2) do |samples|
+      expect(samples).to grow_linearly(:allocations)
+      expect(samples).to grow_linearly(:seconds, 2.0)
+    end
+
+    Quickcheck::Scaling.property(self, "grows linearly with the number of 2400 loops") do
+      claims = between(1, 2)
+
+      measure([25, 50, 100, 200], lambda{|n| hc837(:claims => claims, :lines => n) }) do |input|
+        parse(input)
+      end
+    end.check(2) do |samples|
+      expect(samples).to grow_linearly(:allocations)
+      expect(samples).to grow_linearly(:seconds, 2.0)
+    end
+
+    Quickcheck::Scaling.property(self, "grows linearly with the number of 835 claims") do
+      services = between(1, 4)
+
+      measure([10, 20, 40, 80], lambda{|n| hp835(:claims => n, :services => services) }) do |input|
+        parse(input)
+      end
+    end.check(2) do |samples|
+      expect(samples).to grow_linearly(:allocations)
+      expect(samples).to grow_linearly(:seconds, 2.0)
+    end
+
+    Quickcheck::Scaling.property(self, "grows linearly with the number of 834 members") do
+      shape = { :coverages => between(1, 3), :races => between(1, 3) }
+
+      measure([10, 20, 40, 80], lambda{|n| be834(shape.merge(:members => n)) }) do |input|
+        parse(input)
+      end
+    end.check(2) do |samples|
+      expect(samples).to grow_linearly(:allocations)
+      expect(samples).to grow_linearly(:seconds, 2.0)
+    end
+
+    Quickcheck::Scaling.property(self, "grows linearly with the number of repetitions") do
+      members = between(1, 5)
+
+      measure([10, 20, 40, 80], lambda{|n| be834(:members => members, :races => n) }) do |input|
+        parse(input)
+      end
+    end.check(2) do |samples|
+      expect(samples).to grow_linearly(:allocations)
+      expect(samples).to grow_linearly(:seconds, 2.0)
+    end
+  end
+
+  describe "#next" do
+    Quickcheck::Scaling.property(self, "visits each segment in linear time") do
+      shape = { :patients => between(0, 2), :claims => between(1, 2), :lines => between(1, 2) }
+
+      measure([10, 20, 40, 80], lambda{|n| parse(hc837(shape.merge(:subscribers => n))) }) do |machine|
+        m = machine.first
+        m = m.flatmap(&:next) while m.defined?
+      end
+    end.check(2) do |samples|
+      expect(samples).to grow_linearly(:allocations)
+      expect(samples).to grow_linearly(:seconds, 2.0)
+    end
+  end
+
+  describe "#find" do
+    Quickcheck::Scaling.property(self, "visits each sibling loop in linear time") do
+      measure([25, 50, 100, 200], lambda{|n| [parse(hc837(:lines => n)), n] }) do |machine, n|
+        m = first_line(machine)
+        (n - 1).times { m = m.flatmap{|x| x.find(:LX) } }
+        m.fetch
+      end
+    end.check(2) do |samples|
+      expect(samples).to grow_linearly(:allocations)
+      expect(samples).to grow_linearly(:seconds, 2.0)
+    end
+  end
+
+  describe Stupidedi::Zipper::AbstractCursor do
+    describe "#between" do
+      Quickcheck::Scaling.property(self, "collects sibling loops in linear time") do
+        claims = between(1, 2)
+
+        measure([25, 50, 100, 200], lambda{|n| parse(hc837(:claims => claims, :lines => n)) }) do |machine|
+          # From the first service line of the first claim to the IEA segment,
+          # which spans the sibling 2400 loops and the rest of the tree
+          a = first_line(machine).fetch.zipper.fetch
+          b = machine.last.fetch.zipper.fetch
+          a.between(b)
+        end
+      end.check(2) do |samples|
+        expect(samples).to grow_linearly(:allocations)
+        expect(samples).to grow_linearly(:seconds, 2.0)
+      end
+    end
+
+    describe "#flatten" do
+      Quickcheck::Scaling.property(self, "visits each node in linear time") do
+        shape = { :patients => between(0, 2), :claims => between(1, 2), :lines => between(1, 2) }
+
+        measure([10, 20, 40, 80], lambda{|n| parse(hc837(shape.merge(:subscribers => n))) }) do |machine|
+          machine.zipper.fetch.root.flatten
+        end
+      end.check(2) do |samples|
+        # The only objects allocated are a few arrays, however many nodes
+        # there are, so only the time is checked
+        expect(samples).to grow_linearly(:seconds, 2.0)
+      end
+    end
+  end
+end
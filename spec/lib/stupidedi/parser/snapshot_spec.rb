@@ -0,0 +1,160 @@
+require "stringio"
+
+describe Stupidedi::Parser::Snapshot do
+  using Stupidedi::Refinements
+
+  let(:config) { Stupidedi::Config.hipaa }
+
+  let(:input) do
+    Fixtures.read("005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi")
+  end
+
+  let(:machine) { Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input)).head }
+
+  def write(machine)
+    Stupidedi::Writer::Default.new(machine.zipper.fetch.root).write
+  end
+
+  def positions(machine)
+    positions = []
+    cursor    = machine.first
+    while cursor.defined?
+      positions << cursor.flatmap{|m| m.segment }.map{|s| p = s.node.position; [p.offset, p.line, p.column] }.fetch
+      cursor = cursor.flatmap{|m| m.next }
+    end
+    positions
+  end
+
+  def segments(value)
+    value.segment? ? [value] : value.children.flat_map{|c| segments(c) }
+  end
+
+  # Lists the offset of each element, including the ISA16 separator and
+  # the empty elements that weren't in the input
+  def offsets(machine)
+    machine.zipper.fetch.root.flatten.select(&:element?).map do |e|
+      e.position.offset if e.position.respond_to?(:offset)
+    end
+  end
+
+  describe ".load" do
+    it "builds the same parse tree" do
+      loaded = Stupidedi::Parser::Snapshot.load(config, Stupidedi::Parser::Snapshot.dump(machine))
+
+      expect(write(loaded)).to be == write(machine)
+      expect(loaded.deterministic?).to be == true
+      expect(loaded.last?).to be == true
+    end
+
+    it "keeps the offset, line, and column of each segment" do
+      loaded = Stupidedi::Parser::Snapshot.load(config, Stupidedi::Parser::Snapshot.dump(machine))
+      expect(positions(loaded)).to be == positions(machine)
+    end
+
+    it "keeps the offset of each element" do
+      loaded = Stupidedi::Parser::Snapshot.load(config, Stupidedi::Parser::Snapshot.dump(machine))
+      expect(offsets(loaded)).to be == offsets(machine)
+    end
+
+    it "reads from an IO" do
+      io = StringIO.new("".b)
+      Stupidedi::Parser::Snapshot.dump(machine, io)
+      io.rewind
+
+      expect(write(Stupidedi::Parser::Snapshot.load(config, io))).to be == write(machine)
+    end
+
+    it "returns a tree that can be navigated" do
+      loaded = Stupidedi::Parser::Snapshot.load(config, Stupidedi::Parser::Snapshot.dump(machine))
+
+      expect(loaded.first.flatmap{|m| m.find(:GS) }.flatmap{|m| m.find(:ST) }.flatmap{|m| m.find(:BPR) }
+        .flatmap{|m| m.element(2) }.map{|e| e.node.to_s }.fetch).to be ==
+        machine.first.flatmap{|m| m.find(:GS) }.flatmap{|m| m.find(:ST) }.flatmap{|m| m.find(:BPR) }
+          .flatmap{|m| m.element(2) }.map{|e| e.node.to_s }.fetch
+    end
+
+    it "returns a tree that can be critiqued" do
+      editor = Stupidedi::Editor::TransmissionEd.new(config, Time.now)
+      loaded = Stupidedi::Parser::Snapshot.load(config, Stupidedi::Parser::Snapshot.dump(machine))
+
+      expect(editor.critique(loaded).results.length).to be ==
+        editor.critique(machine).results.length
+    end
+
+    it "keeps the element text unconverted with Config#lazy_elements" do
+      lazy = Stupidedi::Config.hipaa
+      lazy.lazy_elements = true
+
+      loaded = Stupidedi::Parser::Snapshot.load(lazy, Stupidedi::Parser::Snapshot.dump(machine))
+      bpr02  = loaded.first.flatmap{|m| m.find(:GS) }.flatmap{|m| m.find(:ST) }
+        .flatmap{|m| m.find(:BPR) }.flatmap{|m| m.element(2) }.fetch.node
+
+      expect(bpr02).to be_a(Stupidedi::Values::LazyElementVal)
+      expect(write(loaded)).to be == write(machine)
+    end
+
+    it "doesn't convert the elements until they're used" do
+      loaded   = Stupidedi::Parser::Snapshot.load(config, Stupidedi::Parser::Snapshot.dump(machine))
+      segments = segments(loaded.zipper.fetch.root.node)
+
+      # The ISA segment's elements are used to find the separators
+      expect(segments.reject(&:raw?).map(&:id)).to be == [:ISA]
+      expect(write(loaded)).to be == write(machine)
+    end
+
+    it "allocates a fraction of the objects that reading does" do
+      snapshot = Stupidedi::Parser::Snapshot.dump(machine)
+      count    = lambda do |&block|
+        start = GC.stat(:total_allocated_objects)
+        block.call
+        GC.stat(:total_allocated_objects) - start
+      end
+
+      read = count.call { Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input)) }
+      load = count.call { Stupidedi::Parser::Snapshot.load(config, snapshot) }
+      expect(load * 5).to be < read
+    end
+
+    it "rejects data that isn't a snapshot" do
+      expect{ Stupidedi::Parser::Snapshot.load(config, Marshal.dump([])) }.to \
+        raise_error(ArgumentError)
+    end
+
+    it "rejects a truncated snapshot" do
+      snapshot = Stupidedi::Parser::Snapshot.dump(machine)
+
+      expect{ Stupidedi::Parser::Snapshot.load(config, snapshot.byteslice(0, snapshot.bytesize - 10)) }.to \
+        raise_error(ArgumentError)
+    end
+
+    it "rejects values of any other type" do
+      header   = Stupidedi::Parser::Snapshot::FORMAT + "\0"
+      snapshot = header + [Stupidedi::Parser::Snapshot::VERSION, 0, 1].pack("NNN") + [99].pack("w")
+
+      expect{ Stupidedi::Parser::Snapshot.load(config, snapshot) }.to \
+        raise_error(ArgumentError, /invalid/)
+    end
+  end
+
+  describe "Codec" do
+    it "reads the values it writes" do
+      require "pathname"
+      value = [nil, 0, 1, -5, 2**70, "ISA", "\xFF\xFE".b, "caf\u00e9", :REF, Pathname.new("a.edi"), [[], [:x]]]
+      codec = Stupidedi::Parser::Snapshot::Codec
+
+      expect(codec.load(codec.dump(value))).to be == value
+      expect(codec.load(codec.dump(value)).grep(String).map(&:encoding)).to be == value.grep(String).map(&:encoding)
+    end
+
+    it "doesn't write other objects" do
+      expect{ Stupidedi::Parser::Snapshot::Codec.dump([Object.new]) }.to raise_error(ArgumentError)
+    end
+  end
+
+  describe ".dump" do
+    it "rejects a nondeterministic machine" do
+      ambiguous = Stupidedi::Parser::StateMachine.new(config, machine.active + machine.active)
+      expect{ Stupidedi::Parser::Snapshot.dump(ambiguous) }.to raise_error(ArgumentError)
+    end
+  end
+end
@@ -0,0 +1,241 @@
+require "tempfile"
+
+describe Stupidedi::Reader::BufferedInput do
+  using Stupidedi::Refinements
+
+  # Use a tiny block size so reads frequently cross block boundaries
+  def mkinput(string)
+    file = Tempfile.new("buffered-input")
+    file.binmode
+    file.write(string)
+    file.flush
+
+    io     = File.open(file.path, "rb")
+    window = Stupidedi::Reader::BufferedInput::Window.new(io, string.bytesize, 4)
+    Stupidedi::Reader::BufferedInput.new(io, 0, 1, 1, string.bytesize, window)
+  end
+
+  describe "Input.build" do
+    it "wraps IO streams" do
+      File.open(__FILE__) do |file|
+        expect(Stupidedi::Reader::Input.build(file)).to be_a(described_class)
+      end
+    end
+  end
+
+  describe "#position" do
+    it "returns a Position value" do
+      expect(mkinput("").position).to be_a(Stupidedi::Reader::Position)
+    end
+
+    it "includes the file path" do
+      input = mkinput("abc")
+      expect(input.position.path).to be == input.io.path
+    end
+  end
+
+  describe "#defined_at?(n)" do
+    context "when n is less than input length" do
+      property "is true" do
+        with(:size, between(1, 25)) { [string, between(0, size - 1)] }
+      end.check do |s, n|
+        expect(mkinput(s).defined_at?(n)).to be true
+      end
+    end
+
+    context "when n is equal to input length" do
+      property "is false" do
+        with(:size, between(0, 25)) { [string, size] }
+      end.check do |s, n|
+        expect(mkinput(s).defined_at?(n)).to be false
+      end
+    end
+  end
+
+  describe "#empty?" do
+    context "when the input is empty" do
+      it "is true" do
+        expect(mkinput("")).to be_empty
+        expect(mkinput("abc").drop(3)).to be_empty
+      end
+    end
+
+    context "when the input is not empty" do
+      it "is false" do
+        expect(mkinput(" ")).not_to be_empty
+        expect(mkinput("abc").drop(2)).not_to be_empty
+      end
+    end
+  end
+
+  describe "#drop(n)" do
+    context "when n is negative" do
+      it "raises an error" do
+        expect(lambda { mkinput("abc").drop(-1) }).to raise_error("n must be positive")
+      end
+    end
+
+    context "when less than n elements are available" do
+      it "increments the offset" do
+        expect(mkinput("abc").drop(25).offset).to be == 3
+      end
+
+      it "returns an empty input" do
+        expect(mkinput("abc").drop(10)).to be_empty
+      end
+    end
+
+    context "when n elements are available" do
+      property "increments the offset" do
+        with(:size, between(0, 25)) do
+          [string, between(0, size)]
+        end
+      end.check do |s, n|
+        expect(mkinput(s).drop(n).offset).to be == n
+      end
+
+      property "returns an input with the first n elements removed" do
+        with(:size, between(0, 25)) do
+          [string, between(0, size)]
+        end
+      end.check do |s, n|
+        expect(mkinput(s).drop(n).take(s.length)).to be == s.drop(n)
+      end
+    end
+
+    property "increments the line count" do
+      string = array { with(:size, between(0, 15)) { string }}.join("\n")
+      n      = between(0, string.length * 2)
+
+      [string, n]
+    end.check do |s, n|
+      expect(mkinput(s).drop(n).line).to be == 1 + s.take(n).count("\n")
+    end
+
+    it "calculates the column" do
+      input = mkinput("abc\nxyz")
+      expect(input.drop(0).column).to be == 1
+      expect(input.drop(3).column).to be == 4
+      expect(input.drop(4).column).to be == 1
+      expect(input.drop(6).column).to be == 3
+      expect(input.drop(4).drop(2).column).to be == 3
+    end
+  end
+
+  describe "#lazy_positions" do
+    it "returns a LazyPosition value" do
+      expect(mkinput("abc").lazy_positions.position).to be_a(Stupidedi::Reader::LazyPosition)
+    end
+
+    property "computes the same positions" do
+      string = array { with(:size, between(0, 15)) { string }}.join("\n")
+      m      = between(0, string.length)
+      n      = between(0, string.length * 2)
+
+      [string, m, n]
+    end.check do |s, m, n|
+      input = mkinput(s)
+      eager = input.drop(m).drop(n)
+      lazy  = input.lazy_positions.drop(m).drop(n)
+
+      expect(lazy.offset).to be == eager.offset
+      expect(lazy.line).to   be == eager.line
+      expect(lazy.column).to be == eager.column
+      expect(lazy.position.inspect).to be == eager.position.inspect
+    end
+  end
+
+  describe "#scan_lines" do
+    it "computes positions after the stream is closed" do
+      input = mkinput("ab\ncd\nef").lazy_positions.drop(7)
+      input.scan_lines.io.close
+
+      expect(input.line).to   be == 3
+      expect(input.column).to be == 2
+    end
+  end
+
+  describe "#take(n)" do
+    context "when n is zero" do
+      it "returns an empty value" do
+        expect(mkinput("abc").take(0)).to be == ""
+      end
+    end
+
+    context "when n is negative" do
+      it "raises an error" do
+        expect(lambda { mkinput("abc").take(-1) }).to raise_error("n must be positive")
+      end
+    end
+
+    context "when less than n elements are available" do
+      it "returns all available elements" do
+        expect(mkinput("ab").take(3)).to be == "ab"
+      end
+    end
+
+    context "when n elements are available" do
+      property "returns the first n elements" do
+        with(:size, between(0, 25)) do
+          [string, between(0, size)]
+        end
+      end.check do |s, n|
+        expect(mkinput(s).take(n)).to be == s.take(n)
+      end
+    end
+  end
+
+  describe "#at(n)" do
+    context "when n is negative" do
+      it "raises an error" do
+        expect(lambda { mkinput("abc").at(-1) }).to raise_error("n must be positive")
+      end
+    end
+
+    context "when the input is defined_at?(n)" do
+      property "returns the element at index n" do
+        with(:size, between(4, 25)) do
+          [string, between(0, 3), between(0, size - 4)]
+        end
+      end.check do |s, m, n|
+        expect(mkinput(s).drop(m).at(n)).to be == s.at(m + n)
+      end
+
+      it "can read backward after the block has moved forward" do
+        input = mkinput("abcdefghijkl")
+        later = input.drop(10)
+
+        expect(later.at(0)).to be == "k"
+        expect(input.at(1)).to be == "b"
+        expect(later.at(1)).to be == "l"
+      end
+    end
+
+    context "when the input is not defined_at?(n)" do
+      it "returns nil" do
+        expect(mkinput("abc").at(3)).to be_nil
+      end
+    end
+  end
+
+  describe "#index(search)" do
+    context "when search is an element in the input" do
+      it "returns the smallest index" do
+        expect(mkinput("abcabc").index("b")).to be == 1
+        expect(mkinput("abcabc").drop(2).index("b")).to be == 2
+      end
+
+      it "finds elements that span blocks" do
+        expect(mkinput("abcdefghij").index("defg")).to be == 3
+        expect(mkinput("abcdefghij").index("ij")).to be == 8
+      end
+    end
+
+    context "when search is not an element in the input" do
+      it "returns nil" do
+        expect(mkinput("abc").index("d")).to be_nil
+        expect(mkinput("abcdefghij").index("jk")).to be_nil
+      end
+    end
+  end
+end
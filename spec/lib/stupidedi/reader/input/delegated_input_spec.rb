@@ -263,6 +263,36 @@ describe Stupidedi::Reader::DelegatedInput do
     end
   end
 
+  describe "#lazy_positions" do
+    it "returns a LazyPosition value" do
+      expect(mkinput("abc").lazy_positions.position).to be_a(Stupidedi::Reader::LazyPosition)
+    end
+
+    it "ignores Array inputs" do
+      expect(mkinput(%w(a b c)).lazy_positions.position).not_to be_a(Stupidedi::Reader::LazyPosition)
+    end
+
+    property "computes the same positions" do
+      string = array { with(:size, between(0, 15)) { string }}.join("\n")
+      m      = between(0, string.length)
+      n      = between(0, string.length * 2)
+      offset = integer
+      line   = integer
+      column = integer
+
+      [string, m, n, offset, line, column]
+    end.check do |s, m, n, o, l, c|
+      input = mkinput(s, o, l, c)
+      eager = input.drop(m).drop(n)
+      lazy  = input.lazy_positions.drop(m).drop(n)
+
+      expect(lazy.offset).to be == eager.offset
+      expect(lazy.line).to   be == eager.line
+      expect(lazy.column).to be == eager.column
+      expect(lazy.position.inspect).to be == eager.position.inspect
+    end
+  end
+
   describe "#index(search)" do
     context "when search is an element in the input" do
       it "returns the smallest index" do
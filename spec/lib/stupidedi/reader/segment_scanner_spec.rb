@@ -0,0 +1,175 @@
+describe Stupidedi::Reader::SegmentScanner do
+  using Stupidedi::Refinements
+
+  let(:ty) { Stupidedi::Versions::FiftyTen::ElementTypes }
+  let(:id) { ty::ID.new("ID", "Qualifier", 1, 1) }
+  let(:rq) { Stupidedi::Versions::FiftyTen::ElementReqs }
+  let(:s)  { Stupidedi::Schema }
+
+  let(:separators) do
+    Stupidedi::Reader::Separators.new(":", "^", "*", "~")
+  end
+
+  let(:segment_def) do
+    s::SegmentDef.build(:SEG, "Dummy Segment", "",
+      id.simple_use(rq::Mandatory, s::RepeatCount.bounded(1)),
+      id.simple_use(rq::Mandatory, s::RepeatCount.bounded(2)),
+      s::CompositeElementDef.build(:C000, "Dummy Composite", "",
+        id.component_use(rq::Mandatory),
+        id.component_use(rq::Mandatory)).
+        simple_use(rq::Mandatory, s::RepeatCount.bounded(1)),
+      s::CompositeElementDef.build(:C000, "Dummy Composite", "",
+        id.component_use(rq::Mandatory),
+        id.component_use(rq::Mandatory)).
+        simple_use(rq::Mandatory, s::RepeatCount.bounded(2)))
+  end
+
+  let(:dictionary) do
+    Stupidedi::Reader::SegmentDict.build(:SEG => segment_def)
+  end
+
+  def mkinput(string)
+    Stupidedi::Reader::Input.build(string)
+  end
+
+  def mkscanner(input, separators = separators(), segment_dict = dictionary())
+    Stupidedi::Reader::SegmentScanner.new(mkinput(input), separators, segment_dict)
+  end
+
+  def mktokenizer(input, separators = separators(), segment_dict = dictionary())
+    Stupidedi::Reader::TokenReader.new(mkinput(input), separators, segment_dict)
+  end
+
+  # Reduces a token to nested arrays of values and positions, so tokens from
+  # each tokenizer can be compared
+  def flatten(token)
+    position = lambda do |p|
+      p.try{|x| [x.offset, x.line, x.column] }
+    end
+
+    case token
+    when Stupidedi::Reader::SegmentTok
+      [token.id, position[token.position], position[token.remainder],
+       token.element_toks.map{|e| flatten(e) }]
+    when Stupidedi::Reader::RepeatedElementTok
+      [:repeated, position[token.position],
+       token.element_toks.map{|e| flatten(e) }]
+    when Stupidedi::Reader::CompositeElementTok
+      [:composite, position[token.position], position[token.remainder],
+       token.component_toks.map{|e| flatten(e) }]
+    else
+      [token.value, position[token.position], position[token.remainder]]
+    end
+  end
+
+  def read(reader)
+    result = reader.read_segment
+
+    if result.defined?
+      result.map do |token, remainder|
+        [flatten(token), remainder.input.take(10), remainder.stream?]
+      end.fetch
+    else
+      [result.reason, result.fatal?, result.remainder.position.offset]
+    end
+  end
+
+  describe "#stream?" do
+    it "returns false" do
+      expect(mkscanner("")).not_to be_stream
+    end
+  end
+
+  describe "#stream" do
+    it "hands off to another SegmentScanner" do
+      expect(mkscanner("").stream.tokenizer).to be ==
+        Stupidedi::Reader::SegmentScanner
+    end
+  end
+
+  describe "#read_segment" do
+    [ "",
+      "\n\n",
+      "SEG",
+      "~ABC",
+      "0ABC*X~",
+      "ABC:~",
+      "ABCD*X~",
+      "XYZ*A*B",
+      "ABC~...",
+      "ABC*~...",
+      "ABC***O~...",
+      "\r\nABC*M*N*O~\r\nDEF~",
+      "ABC*M\n*N~...",
+      "ABC*A\x01B~...",
+      "ABC*ÀÄ*N~...",
+      "IEA~...",
+      "IEA*A*B~\nISA",
+      "SEG*W:X*Y^Z~...",
+      "SEG**~...",
+      "SEG*W*X^Y^Z*A:B:C~...",
+      "SEG*W*X*A*A:B^C:D^~...",
+      "SEG*W*X*A:B*A:B^:^C*E*F~...",
+      "SEG*W^X*Y*Z~..." ].each do |input|
+      it "tokenizes #{input.inspect} the same way as TokenReader" do
+        expect(read(mkscanner(input))).to be == read(mktokenizer(input))
+      end
+
+      it "tokenizes #{input.inspect} the same way with lazy positions" do
+        lazy = Stupidedi::Reader::SegmentScanner.new(
+          mkinput(input).lazy_positions, separators, dictionary)
+
+        expect(read(lazy)).to be == read(mktokenizer(input))
+      end
+    end
+
+    it "computes the position of each element" do
+      result = mkscanner("ABC~\nSEG*W*X^Y~...").read_segment
+      result.flatmap{|_, remainder| remainder.read_segment }.map do |value, remainder|
+        expect(value.position.line).to    be == 2
+        expect(value.position.column).to  be == 1
+        expect(value.position.offset).to  be == 5
+
+        simple, repeated = value.element_toks
+        expect(simple.position.column).to be == 5
+        expect(repeated.element_toks.map{|e| e.position.column }).to be == [7, 9]
+        expect(remainder.input.position.offset).to be == 15
+      end
+    end
+
+    context "when the segment terminator is a newline" do
+      let(:separators) do
+        Stupidedi::Reader::Separators.new(":", "^", "*", "\n")
+      end
+
+      it "tokenizes the same way as TokenReader" do
+        input = "ABC*X\n\nSEG*W*X^Y\n"
+        expect(read(mkscanner(input))).to be == read(mktokenizer(input))
+
+        mkscanner(input).read_segment.map do |value, remainder|
+          expect(read(remainder)).to be ==
+            read(Stupidedi::Reader::TokenReader.new(remainder.input, separators, dictionary))
+        end
+      end
+    end
+
+    context "when the input starts with an IEA segment" do
+      it "the remainder is a StreamReader that hands off to a SegmentScanner" do
+        mkscanner("IEA*1*1~ISA").read_segment.map do |value, remainder|
+          expect(value.id).to be == :IEA
+          expect(remainder).to be_stream
+          expect(remainder.tokenizer).to be == Stupidedi::Reader::SegmentScanner
+        end
+      end
+    end
+
+    context "when a segment contains control characters" do
+      it "continues with a SegmentScanner" do
+        mkscanner("ABC*M\n*N~...").read_segment.map do |value, remainder|
+          expect(value.element_toks.map(&:value)).to be == %w(M N)
+          expect(remainder).to be_a(Stupidedi::Reader::SegmentScanner)
+        end
+      end
+    end
+  end
+end
@@ -160,5 +160,43 @@ describe "Stupidedi::Reader" do
       e = Stupidedi::Reader.extended_characters
       expect(c - (c - e)).to be_empty
     end
+
+    it "doesn't decode bytes above 127 in binary strings" do
+      expect(Stupidedi::Reader.is_control_character?("\xC9".b)).to be false
+      expect(Stupidedi::Reader.is_control_character?("\x01".b)).to be true
+      expect(Stupidedi::Reader.control_characters).not_to include("\xC9".b)
+    end
+  end
+
+  describe ".build(input, :binary => true)" do
+    let(:fixture) do
+      Fixtures.read("005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi")
+    end
+
+    def read(input, options = {})
+      machine, result = Stupidedi::Parser.build(Stupidedi::Config.hipaa).read(Stupidedi::Reader.build(input, options))
+      expect(result).not_to be_fatal
+
+      machine.first.flatmap{|m| m.sequence(:GS, :ST, :LX, :CLP, :NM1) }.
+        flatmap{|m| m.element(3) }.map{|e| e.node.to_s }.fetch
+    end
+
+    it "reads the input as bytes" do
+      expect(read(fixture, :binary => true).encoding).to be == Encoding::BINARY
+      expect(read(fixture, :binary => true)).to be == read(fixture)
+    end
+
+    it "keeps bytes that aren't valid in the input's encoding" do
+      # An ISO-8859-1 "É" in a string that's tagged as UTF-8
+      input = fixture.b.sub("NM1*QC*1*", "NM1*QC*1*\xC9".b).force_encoding(Encoding::UTF_8)
+      expect(input).not_to be_valid_encoding
+
+      expect(read(input, :binary => true).dup.force_encoding(Encoding::ISO_8859_1).encode(Encoding::UTF_8)).to be == "ÉBUDD"
+    end
+
+    it "keeps multibyte characters" do
+      input = fixture.dup.force_encoding(Encoding::UTF_8).sub("NM1*QC*1*", "NM1*QC*1*Ā")
+      expect(read(input, :binary => true).dup.force_encoding(Encoding::UTF_8)).to be == "ĀBUDD"
+    end
   end
 end
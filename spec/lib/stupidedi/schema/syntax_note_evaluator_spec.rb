@@ -0,0 +1,50 @@
+describe Stupidedi::Schema::SyntaxNoteEvaluator do
+  using Stupidedi::Refinements
+
+  notes = Stupidedi::Versions::FiftyTen::SyntaxNotes
+
+  # Stands in for a segment with the given elements present
+  def mkzipper(present, length)
+    Stupidedi::Zipper::Tree.build(Stupidedi::Values::SegmentVal.new(
+      (1..length).map{|n| OpenStruct.new(:present? => present.include?(n), :blank? => !present.include?(n)) },
+      nil, nil))
+  end
+
+  def mkbits(present)
+    present.inject(0){|bits, n| bits | (1 << (n - 1)) }
+  end
+
+  [notes::P.build(2, 3, 5), notes::R.build(1, 4), notes::E.build(2, 3, 4),
+   notes::C.build(3, 1, 5), notes::L.build(4, 2, 5)].each do |note|
+    it "agrees with #{note.class.name.split("::").last}#satisfied?" do
+      [0, 1].repeated_permutation(5).each do |flags|
+        present = (1..5).select{|n| flags.at(n - 1) == 1 }
+
+        expect(note.satisfied_by?(mkbits(present))).to be ==
+          note.satisfied?(mkzipper(present, 5))
+      end
+    end
+  end
+
+  describe "#violations" do
+    let(:evaluator) do
+      Stupidedi::Schema::SyntaxNoteEvaluator.new([notes::P.build(1, 2), notes::R.build(3, 4)])
+    end
+
+    it "returns the syntax notes that aren't satisfied" do
+      expect(evaluator.violations(mkbits([1, 2, 3]))).to be_empty
+      expect(evaluator.violations(mkbits([1, 4])).map(&:indexes)).to be == [[1, 2]]
+      expect(evaluator.violations(mkbits([1])).map(&:indexes)).to be == [[1, 2], [3, 4]]
+    end
+
+    it "checks the elements of a segment" do
+      expect(evaluator.violations(mkzipper([2, 4], 4).node).map(&:indexes)).to be == [[1, 2]]
+      expect(evaluator).to be_satisfied(mkzipper([4], 4).node)
+    end
+
+    it "only examines the elements named by a syntax note" do
+      expect(evaluator.indexes).to be == [1, 2, 3, 4]
+      expect(evaluator.present(mkzipper([1, 3, 5], 5).node)).to be == mkbits([1, 3])
+    end
+  end
+end
@@ -0,0 +1,34 @@
+describe Stupidedi::Schema do
+  using Stupidedi::Refinements
+
+  describe ".deep_freeze" do
+    let(:definition) do
+      s = Stupidedi::Schema
+      e = Stupidedi::Versions::FiftyTen::ElementDefs
+      r = Stupidedi::Versions::FiftyTen::ElementReqs
+
+      s::SegmentDef.build(:AMT, "Monetary Amount Information",
+        "To indicate the total monetary amount",
+        e::E522 .simple_use(r::Mandatory,  s::RepeatCount.bounded(1)),
+        e::E782 .simple_use(r::Mandatory,  s::RepeatCount.bounded(1)),
+        Stupidedi::Versions::FiftyTen::SyntaxNotes::P.build(1, 2))
+    end
+
+    it "freezes the definition and what it refers to" do
+      Stupidedi::Schema.deep_freeze(definition)
+
+      expect(definition).to be_frozen
+      expect(definition.element_uses).to be_frozen
+      expect(definition.element_uses.first).to be_frozen
+      expect(definition.element_uses.first.definition).to be_frozen
+      expect(definition.syntax_notes.first).to be_frozen
+      expect(definition.syntax_note_evaluator).to be_frozen
+      expect(definition.name).to be_frozen
+    end
+
+    it "doesn't freeze modules" do
+      Stupidedi::Schema.deep_freeze(definition)
+      expect(Stupidedi::Versions::FiftyTen::ElementDefs).not_to be_frozen
+    end
+  end
+end
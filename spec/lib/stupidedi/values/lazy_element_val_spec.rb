@@ -0,0 +1,74 @@
+describe Stupidedi::Values::LazyElementVal do
+  using Stupidedi::Refinements
+
+  let(:input) do
+    Fixtures.read("005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi")
+  end
+
+  def config(lazy)
+    Stupidedi::Config.hipaa.customize{|c| c.lazy_elements = lazy }
+  end
+
+  def read(config)
+    machine, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+    machine
+  end
+
+  # Lists each simple element in the parse tree
+  def elements(value, result = [])
+    if value.simple? or value.component?
+      result << value
+    elsif value.respond_to?(:children)
+      value.children.each{|c| elements(c, result) }
+    end
+
+    result
+  end
+
+  let(:eager) { elements(read(config(false)).zipper.fetch.root.node) }
+  let(:lazy)  { elements(read(config(true)).zipper.fetch.root.node) }
+
+  it "isn't used by default" do
+    expect(eager.count{|e| e.is_a?(Stupidedi::Values::LazyElementVal) }).to be == 0
+    expect(Stupidedi::Config.new.lazy_elements).to be == false
+  end
+
+  it "is used for elements in transaction sets" do
+    expect(lazy.count{|e| e.instance_variable_defined?(:@text) }).to be > 0
+  end
+
+  it "isn't converted while parsing" do
+    expect(lazy.count{|e| e.instance_variable_defined?(:@__materialize) }).to be == 0
+  end
+
+  it "behaves like the value from eager parsing" do
+    expect(lazy.length).to be == eager.length
+
+    lazy.zip(eager) do |l, e|
+      expect(l.inspect).to    be == e.inspect
+      expect(l.to_s).to       be == e.to_s
+      expect(l.to_x12).to     be == e.to_x12
+      expect(l.valid?).to     be == e.valid?
+      expect(l.empty?).to     be == e.empty?
+      expect(l.allowed?).to   be == e.allowed?
+      expect(l.date?).to      be == e.date?
+      expect(l.numeric?).to   be == e.numeric?
+      expect(l.is_a?(e.class)).to be == true
+      expect(l).to            be == e if e.valid? and not e.separator?
+    end
+  end
+
+  it "delegates type-specific methods" do
+    machine = read(config(true))
+    clp03   = machine.first.flatmap{|m| m.sequence(:GS, :ST, :LX, :CLP) }.
+      flatmap{|m| m.element(3) }.map(&:node).fetch
+    dtm02   = machine.first.flatmap{|m| m.sequence(:GS, :ST, :DTM) }.
+      flatmap{|m| m.element(2) }.map(&:node).fetch
+
+    expect(Stupidedi::Values::LazyElementVal === clp03).to be == true
+    expect(clp03.to_d).to be == BigDecimal("800")
+    expect(clp03 + 1).to be == 801
+    expect(dtm02.to_date).to be == Date.new(2002, 3, 14)
+    expect(dtm02).to respond_to(:month)
+  end
+end
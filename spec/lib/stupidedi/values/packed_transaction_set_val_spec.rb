@@ -0,0 +1,86 @@
+describe Stupidedi::Values::PackedTransactionSetVal do
+  using Stupidedi::Refinements
+
+  let(:config) { Stupidedi::Config.hipaa }
+
+  let(:input) do
+    Fixtures.read("005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi")
+  end
+
+  def transaction_set(input, options = {})
+    machine, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input, options))
+    value = machine.zipper.fetch.root.node
+    value = value.children.find{|c| not c.segment? } until value.transaction_set?
+    value
+  end
+
+  # Lists each segment and simple element in the tree with its position
+  def values(value, result = [])
+    if value.segment? or value.simple? or value.component?
+      result << [value.class, value.position.class, value.position.offset,
+        value.position.line, value.position.column]
+      result.last << value.to_x12 unless value.segment?
+    end
+
+    if value.respond_to?(:children) and not value.leaf?
+      value.children.each{|c| values(c, result) }
+    end
+
+    result
+  end
+
+  def segments(value)
+    value.segment? ? [value] : value.children.flat_map{|c| segments(c) }
+  end
+
+  let(:unpacked) { transaction_set(input) }
+  let(:packed)   { unpacked.pack }
+
+  it "builds the same tree" do
+    expect(packed).to be_transaction_set
+    expect(packed).to be == unpacked
+    expect(unpacked).to be == packed
+    expect(packed.size).to be == unpacked.size
+    expect(values(packed.unpack)).to be == values(unpacked)
+  end
+
+  it "doesn't retain the values it builds" do
+    expect(packed.children).to be == packed.children
+    expect(packed.children.head).not_to equal(packed.children.head)
+  end
+
+  it "yields each segment in order" do
+    expect(packed.each_segment.map(&:id)).to be == segments(unpacked).map(&:id)
+    expect(packed.position.offset).to be == unpacked.position.offset
+  end
+
+  it "rebuilds lazy positions" do
+    unpacked = transaction_set(input, :lazy_positions => true)
+    position = unpacked.pack.each_segment.to_a.last.element(1).position
+
+    expect(position).to be_a(Stupidedi::Reader::LazyPosition)
+    expect(values(unpacked.pack.unpack)).to be == values(unpacked)
+  end
+
+  it "keeps segments it can't rebuild" do
+    unpacked = transaction_set(input.sub("LX*1~", "LX*1~ZZ*1~"))
+    invalid  = unpacked.pack.each_segment.find(&:invalid?)
+
+    expect(invalid).to be_a(Stupidedi::Values::InvalidSegmentVal)
+    expect(invalid.id).to be == :ZZ
+    expect(values(unpacked.pack.unpack)).to be == values(unpacked)
+  end
+
+  it "is smaller than the tree" do
+    require "objspace"
+
+    sizes = lambda do |value, seen = {}.compare_by_identity|
+      next 0 if seen.key?(value) or value.is_a?(Module)
+      next 0 if value.is_a?(Stupidedi::Schema::AbstractDef) or value.is_a?(Stupidedi::Schema::AbstractUse)
+      seen[value] = true
+      ObjectSpace.memsize_of(value) + ObjectSpace.reachable_objects_from(value).sum{|x| sizes.call(x, seen) }
+    end
+
+    expect(sizes.call(packed) * 4).to be < sizes.call(unpacked)
+  end
+end
@@ -178,5 +178,12 @@ describe Stupidedi::Versions::Common::ElementTypes::AN do
       specify { expect("ABC" + value("abc")).to eq("ABCabc") }
       specify { expect(value("ABC") + "abc").to eq("ABCabc") }
     end
+
+    describe "#value" do
+      specify { expect(value("ABC").value).to         equal(value("ABC ").value) }
+      specify { expect(value("ABCDEFGHIJKL").value).to_not equal(value("ABCDEFGHIJKL").value) }
+      specify { expect(value("ABC").value).to be_frozen }
+      specify { expect(value("ABC").to_s).to  be_frozen }
+    end
   end
 end
@@ -108,5 +108,18 @@ describe Stupidedi::Versions::Common::ElementTypes::ID do
       specify { expect(value(" ABC")).to    eq(" ABC") }
       specify { expect(value(" ABC ")).to   eq(" ABC") }
     end
+
+    describe "#value" do
+      specify { expect(value("ABC").value).to     equal(value("ABC ").value) }
+      specify { expect(value("ABC").value).to     be_frozen }
+      specify { expect(value("ABC").to_s).to      be_frozen }
+      specify { expect(value("ABC").position).to  equal(position) }
+    end
+
+    describe "#force_encoding(encoding)" do
+      let(:element_val) { value("ABC") }
+      specify { expect(element_val.force_encoding("BINARY").value.encoding).to eq(Encoding::BINARY) }
+      specify { expect(element_val.tap{|x| x.force_encoding("BINARY") }.value.encoding).to_not eq(Encoding::BINARY) }
+    end
   end
 end
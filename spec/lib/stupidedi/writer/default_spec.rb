@@ -138,4 +138,36 @@ describe Stupidedi::Writer::Default do
       expect(result).to be_a(String)
     end
   end
+
+  context "when given an IO" do
+    let(:io) do
+      Class.new do
+        attr_reader :chunks
+        def initialize; @chunks = []; end
+        def <<(x); @chunks << x.dup; self; end
+      end.new
+    end
+
+    it "writes the same output in chunks" do
+      zipper = zipper(separators)
+      result = Stupidedi::Writer::Default.new(zipper, separators).write
+
+      expect(Stupidedi::Writer::Default.new(zipper, separators).write(io)).to equal(io)
+      expect(io.chunks.length).to eq(1)
+      expect(io.chunks.join).to eq(result)
+    end
+
+    it "writes chunks of at least the chunk size" do
+      zipper = zipper(separators)
+      result = Stupidedi::Writer::Default.new(zipper, separators).write
+      buffer = Stupidedi::Writer::Buffer.new(io, 100)
+
+      Stupidedi::Writer::Default.new(zipper, separators).write(buffer)
+      buffer.flush
+
+      expect(io.chunks.length).to be > 1
+      expect(io.chunks[0..-2].map(&:bytesize).min).to be >= 100
+      expect(io.chunks.join).to eq(result)
+    end
+  end
 end
@@ -0,0 +1,96 @@
+describe Stupidedi::Writer::Json do
+  using Stupidedi::Refinements
+
+  let(:config) { Stupidedi::Config.hipaa }
+
+  # Two interchanges, each with one transaction set
+  let(:input) do
+    interchange = Fixtures.interchange
+    [interchange, interchange.gsub("000000905", "000000906")].join("\n")
+  end
+
+  let(:machine) do
+    machine, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+    machine
+  end
+
+  def lines(options = {})
+    output = StringIO.new
+    Stupidedi::Writer::Json.new(output, options).write(machine.zipper.fetch.root).flush
+    output.string.lines.map{|l| JSON.parse(l) }
+  end
+
+  def segments(json)
+    json.key?("segment") ? [json["segment"]] : json["children"].flat_map{|c| segments(c) }
+  end
+
+  def segments_with(json, id)
+    return (json["segment"] == id ? [json] : []) if json.key?("segment")
+    json["children"].flat_map{|c| segments_with(c, id) }
+  end
+
+  def loops(json)
+    return [] if json.key?("segment")
+    [json["loop"]].compact + json["children"].flat_map{|c| loops(c) }
+  end
+
+  it "writes one line for each transaction set" do
+    lines = lines()
+
+    expect(lines.length).to eq(2)
+    expect(lines.map{|l| l["transaction_set"] }).to eq(%w(835 835))
+    expect(lines.map{|l| l["interchange"]["elements"][12] }).to eq(%w(000000905 000000906))
+    expect(lines.first["group"]["segment"]).to eq("GS")
+  end
+
+  it "writes every segment" do
+    json = lines.first
+
+    expect(segments(json).first(3)).to eq(%w(ST BPR TRN))
+    expect(segments(json).last).to eq("SE")
+    expect(segments(json).count("CLP")).to eq(2)
+  end
+
+  it "writes elements" do
+    segment = lambda{|id| segments_with(lines.first, id).first }
+
+    expect(segment.call("CLP")["elements"]).to eq(%w(5554555444 1 800 450 300 12 94060555410000))
+    expect(segment.call("NM1")["elements"]).to eq(["QC", "1", "BUDD", "WILLIAM", nil, nil, nil, "MI", "33344555510"])
+    expect(segment.call("SVC")["elements"].first).to eq(%w(HC 99211))
+  end
+
+  context "with a projection" do
+    it "only writes the named loops and segments" do
+      json = lines(:only => %w(2100 BPR)).first
+
+      expect(segments(json).first).to eq("BPR")
+      expect(segments(json)).not_to include("ST")
+      expect(segments(json).count("CLP")).to eq(2)
+      expect(loops(json).uniq).to eq(["2000 HEADER NUMBER",
+        "2100 CLAIM PAYMENT INFORMATION", "2110 SERVICE PAYMENT INFORMATION"])
+      expect(json["children"].map{|t| t["table"] }).to eq(["1 - Header", "2 - Detail"])
+    end
+
+    it "writes the envelope segments" do
+      json = lines(:only => %w(SE)).first
+
+      expect(json["interchange"]["segment"]).to eq("ISA")
+      expect(segments(json)).to eq(%w(SE))
+    end
+  end
+
+  context "when used with each_transaction_set" do
+    it "writes the same lines" do
+      expected = lines()
+      output   = StringIO.new
+      writer   = Stupidedi::Writer::Json.new(output)
+
+      Stupidedi::Parser.build(config).each_transaction_set(Stupidedi::Reader.build(input)) do |zipper|
+        writer.write(zipper)
+      end
+
+      writer.flush
+      expect(output.string.lines.map{|l| JSON.parse(l) }).to eq(expected)
+    end
+  end
+end
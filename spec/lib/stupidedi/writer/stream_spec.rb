@@ -0,0 +1,106 @@
+describe Stupidedi::Writer::Stream do
+  using Stupidedi::Refinements
+
+  let(:config)     { Stupidedi::Config.hipaa }
+  let(:separators) { Stupidedi::Reader::Separators.build(:segment => "~\n", :element => "*", :component => ":", :repetition => "^") }
+
+  # Two interchanges, each with one transaction set
+  let(:input) do
+    interchange = Fixtures.interchange
+    [interchange, interchange.gsub("000000905", "000000906")].join("\n")
+  end
+
+  def expected
+    machine, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+    Stupidedi::Writer::Default.new(machine.zipper.fetch.root, separators).write
+  end
+
+  it "writes the same output as Writer::Default" do
+    output  = StringIO.new
+    writer  = Stupidedi::Writer::Stream.new(output, separators)
+    yielded = 0
+
+    machine, = Stupidedi::Parser.build(config).each_transaction_set(Stupidedi::Reader.build(input)) do |zipper|
+      writer.write(zipper)
+      yielded += 1
+    end
+
+    expect(yielded).to eq(2)
+    expect(writer.finish(machine.zipper.fetch)).to equal(writer)
+    expect(output.string).to eq(expected)
+  end
+
+  it "writes each envelope segment once" do
+    output = ""
+    writer = Stupidedi::Writer::Stream.new(output, separators)
+
+    machine, = Stupidedi::Parser.build(config).each_transaction_set(Stupidedi::Reader.build(input)) do |zipper|
+      writer.write(zipper).write(zipper)
+    end
+
+    writer.finish(machine.zipper.fetch)
+    expect(output.scan(/^(ISA|GS|GE|IEA)\*/).length).to eq(8)
+  end
+
+  it "doesn't visit the interchanges that were finished" do
+    visited = []
+    writer  = Class.new(Stupidedi::Writer::Stream) do
+      define_method(:interchange){|value, separators| visited << value; super(value, separators) }
+    end.new("", separators)
+
+    machine, = Stupidedi::Parser.build(config).each_transaction_set(Stupidedi::Reader.build(input)) do |zipper|
+      writer.write(zipper)
+    end
+
+    writer.finish(machine.zipper.fetch)
+    expect(visited.length).to eq(2)
+  end
+
+  it "writes a transaction set that wasn't yielded before the next one" do
+    # The first transaction set has no SE segment, so it isn't yielded and
+    # stays in the parse tree while the second one is written
+    missing = Fixtures.transmission(Fixtures.transaction_set("0001").sub(/^SE.*?~/, ""),
+                                    Fixtures.transaction_set("0002"))
+
+    output  = ""
+    writer  = Stupidedi::Writer::Stream.new(output, separators)
+    yielded = 0
+
+    machine, = Stupidedi::Parser.build(config).each_transaction_set(Stupidedi::Reader.build(missing)) do |zipper|
+      writer.write(zipper)
+      yielded += 1
+    end
+
+    writer.finish(machine.zipper.fetch)
+    expect(yielded).to eq(1)
+    expect(output.scan(/^(?:ST|GE)\*[^~]*/)).to eq(["ST*835*0001", "ST*835*0002", "GE*2*1"])
+
+    machine, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(missing))
+    expect(output).to eq(Stupidedi::Writer::Default.new(machine.zipper.fetch.root, separators).write)
+  end
+
+  it "writes each transaction set of a parse tree once" do
+    output   = ""
+    writer   = Stupidedi::Writer::Stream.new(output, separators)
+    machine, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+
+    zipper = machine.first.flatmap{|m| m.find(:GS) }.flatmap{|m| m.find(:ST) }.fetch.zipper.fetch
+    zipper = zipper.up until zipper.node.transaction_set?
+
+    # Nothing after the transaction set is written until it's finished
+    writer.write(zipper).write(zipper).flush
+    expect(output.scan(/^(?:ISA|GS|ST|SE|GE|IEA)\*/)).to eq(["ISA*", "GS*", "ST*", "SE*"])
+
+    writer.finish(machine.zipper.fetch)
+
+    expect(output).to eq(expected)
+  end
+
+  it "writes transaction sets that weren't yielded when finished" do
+    output = ""
+    machine, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+
+    Stupidedi::Writer::Stream.new(output, separators).finish(machine.zipper.fetch)
+    expect(output).to eq(expected)
+  end
+end
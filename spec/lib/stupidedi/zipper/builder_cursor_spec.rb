@@ -0,0 +1,121 @@
+describe Stupidedi::Zipper::BuilderCursor do
+  using Stupidedi::Refinements
+
+  let(:root)    { Stupidedi::Zipper::Builder.build(Node.new("a")) }
+  let(:root_a)  { root.append_child(Node.new("b"))  }
+  let(:root_b)  { root_a.append(Node.new("c"))      }
+  let(:root_c)  { root_b.append(Node.new("d"))      }
+  let(:root_ba) { root_b.append_child(Node.new("e")) }
+
+  describe ".build" do
+    it "returns a root cursor" do
+      expect(root).to be_root
+      expect(root.depth).to eq(0)
+    end
+  end
+
+  describe "#append" do
+    it "adds a sibling" do
+      expect(root_c.up.node.inspect).to eq("a(b, c, d)")
+      expect(root_c.depth).to eq(1)
+      expect(root_c.path.position).to eq(2)
+    end
+
+    it "doesn't change the tree seen by other cursors" do
+      other = root_b.append(Node.new("x"))
+
+      expect(root_c.up.node.inspect).to eq("a(b, c, d)")
+      expect(other.up.node.inspect).to eq("a(b, c, x)")
+      expect(root_b.up.node.inspect).to eq("a(b, c)")
+      expect(root_a.up.node.inspect).to eq("a(b)")
+    end
+
+    it "doesn't change the tree seen by a replaced cursor" do
+      other = root_b.replace(Node.new("x")).append(Node.new("y"))
+
+      expect(other.up.node.inspect).to eq("a(b, x, y)")
+      expect(root_c.up.node.inspect).to eq("a(b, c, d)")
+    end
+
+    it "raises an error on root" do
+      expect(lambda { root.append(Node.new("x")) }).to \
+        raise_error(Stupidedi::Exceptions::ZipperError)
+    end
+  end
+
+  describe "#up" do
+    it "rebuilds each ancestor" do
+      expect(root_ba.append(Node.new("f")).root.node.inspect).to eq("a(b, c(e, f))")
+    end
+
+    it "raises an error on root" do
+      expect(lambda { root.up }).to \
+        raise_error(Stupidedi::Exceptions::ZipperError)
+    end
+  end
+
+  describe "#dangle" do
+    it "creates a placeholder in a node without children" do
+      expect(root.dangle.append(Node.new("x")).up.node.inspect).to eq("a(x)")
+    end
+
+    it "moves to the first child" do
+      tree = root_c.up
+
+      expect(tree.dangle.node.inspect).to eq("b")
+      expect(tree.dangle.last.append(Node.new("x")).up.node.inspect).to eq("a(b, c, d, x)")
+    end
+  end
+
+  describe "#next, #prev, #first, #last" do
+    let(:tree) { root_c.up.dangle }
+
+    it "moves between siblings" do
+      expect(tree.next.node.inspect).to eq("c")
+      expect(tree.last.node.inspect).to eq("d")
+      expect(tree.last.prev.node.inspect).to eq("c")
+      expect(tree.last.first.node.inspect).to eq("b")
+      expect(tree.next.prepend(Node.new("x")).up.node.inspect).to eq("a(b, x, c, d)")
+    end
+  end
+
+  describe "#delete" do
+    it "removes the node" do
+      expect(root_c.delete.up.node.inspect).to eq("a(b, c)")
+      expect(root_c.up.dangle.delete.up.node.inspect).to eq("a(c, d)")
+      expect(root_a.delete.up.node.inspect).to eq("a")
+    end
+  end
+
+  context "when used by the parser" do
+    let(:config) { Stupidedi::Config.hipaa }
+
+    let(:input) do
+      Fixtures.read("005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi")
+    end
+
+    def segments(machine)
+      segments = []
+      cursor   = machine.first
+
+      while cursor.defined?
+        cursor = cursor.flatmap do |m|
+          m.segment.tap{|s| segments << [s.node.id, s.node.position.offset] }
+          m.next
+        end
+      end
+
+      segments
+    end
+
+    it "builds the same parse tree" do
+      expected, = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+      machine,  = Stupidedi::Parser.build(config, Stupidedi::Zipper::Builder).
+        read(Stupidedi::Reader.build(input))
+
+      expect(machine).to be_deterministic
+      expect(segments(machine)).to eq(segments(expected))
+      expect(machine.zipper.fetch.root.node.children.length).to eq(1)
+    end
+  end
+end
@@ -0,0 +1,114 @@
+describe Stupidedi do
+  using Stupidedi::Refinements
+
+  describe ".preload" do
+    let(:config) do
+      Stupidedi::Config.default.customize do |c|
+        c.transaction_set.register("005010X231A1", "FA", "999") { Stupidedi::TransactionSets::FiftyTen::Implementations::X231A1::FA999 }
+      end
+    end
+
+    it "loads and freezes the definitions in the config" do
+      expect(Stupidedi.preload(config)).to equal(config)
+
+      expect(config.transaction_set.at("005010X231A1", "FA", "999")).to be_frozen
+      expect(config.functional_group.at("005010")).to be_frozen
+      expect(config.interchange.at("00501")).to be_frozen
+    end
+
+    it "parses with the frozen definitions" do
+      Stupidedi.preload(config)
+
+      input = Fixtures.read("005010/X231A1 FA999 Implementation Acknowledgment for Health Care Insurance/pass/response-to-functional-group-containing-3-837s.edi")
+      machine, result = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+
+      expect(result).not_to be_fatal
+      st = machine.first.flatmap{|m| m.sequence(:GS, :ST) }.flatmap(&:segmentn).fetch
+      expect(st).to be_valid
+      expect(st.definition).to be_frozen
+    end
+  end
+
+  describe ".make_shareable", :if => defined?(Ractor) do
+    let(:config) do
+      Stupidedi::Config.default.customize do |c|
+        c.transaction_set.register("005010X231A1", "FA", "999") { Stupidedi::TransactionSets::FiftyTen::Implementations::X231A1::FA999 }
+      end
+    end
+
+    let(:input) do
+      Fixtures.read("005010/X231A1 FA999 Implementation Acknowledgment for Health Care Insurance/pass/response-to-functional-group-containing-3-837s.edi")
+    end
+
+    def summary(config, input)
+      machine, result = Stupidedi::Parser.build(config).read(Stupidedi::Reader.build(input))
+      ids = machine.first.flatmap{|m| m.sequence(:GS, :ST) }.map{|m| m.segment.fetch.node.id }
+      [result.fatal?, ids.fetch]
+    end
+
+    it "returns a shareable copy of the config and its definitions" do
+      shared = Stupidedi.make_shareable(config, "005010X231A1")
+
+      expect(shared).not_to equal(config)
+      expect(Ractor.shareable?(config)).to be == false
+      expect(Ractor.shareable?(shared)).to be == true
+      expect(shared.transaction_set.at("005010X231A1", "FA", "999")).to equal(config.transaction_set.at("005010X231A1", "FA", "999"))
+      expect(Ractor.shareable?(shared.transaction_set.at("005010X231A1", "FA", "999"))).to be == true
+      expect(Ractor.shareable?(Stupidedi::Versions::FiftyTen::SegmentDefs::ST)).to be == true
+    end
+
+    it "only copies the transaction sets of the given versions" do
+      shared = Stupidedi.make_shareable(Stupidedi::Config.hipaa, "005010X231A1")
+
+      expect(shared.transaction_set).to be_defined_at("005010X231A1", "FA", "999")
+      expect(shared.transaction_set).not_to be_defined_at("005010X222A1", "HC", "837")
+    end
+
+    it "parses the same way in another Ractor" do
+      shared = Stupidedi.make_shareable(config, "005010X231A1")
+
+      ractor = Ractor.new(shared, input.dup.freeze) do |c, x|
+        machine, result = Stupidedi::Parser.build(c).read(Stupidedi::Reader.build(x))
+        ids = machine.first.flatmap{|m| m.sequence(:GS, :ST) }.map{|m| m.segment.fetch.node.id }
+        [result.fatal?, ids.fetch]
+      end
+
+      expect(ractor.take).to be == summary(config, input)
+    end
+
+    it "loads the classes the parser needs in other Ractors" do
+      # The other examples have already loaded the parser by the time this
+      # runs, so start a new process where nothing has been parsed yet
+      script = <<-RUBY
+        require "stupidedi"
+        require "ruby/blank"
+        Warning[:experimental] = false
+
+        config = Stupidedi::Config.default.customize do |c|
+          c.transaction_set.register("005010X231A1", "FA", "999") { Stupidedi::TransactionSets::FiftyTen::Implementations::X231A1::FA999 }
+        end
+
+        shared  = Stupidedi.make_shareable(config, "005010X231A1")
+        input   = $stdin.binmode.read.freeze
+        ractors = [{}, { :binary => true }].map do |options|
+          Ractor.new(shared, input, options) do |c, x, o|
+            machine, result = Stupidedi::Parser.build(c).read(Stupidedi::Reader.build(x, o))
+            ids = machine.first.flatmap{|m| m.sequence(:GS, :ST) }.map{|m| m.segment.fetch.node.id }
+            [result.fatal?, ids.fetch]
+          end
+        end
+
+        p ractors.map(&:take)
+      RUBY
+
+      lib    = File.expand_path("../../../lib", __FILE__)
+      output = IO.popen([RbConfig.ruby, "-I", lib, "-e", script], "r+b") do |io|
+        io.write(input)
+        io.close_write
+        io.read
+      end
+
+      expect(output.chomp).to be == ([summary(config, input)] * 2).inspect
+    end
+  end
+end
@@ -41,6 +41,41 @@ Fixtures = Class.new do
     File.open(File.join(@root, path), "rb", &:read)
   end
 
+  # The ISA and GS segments and the transaction set of the HP835 fixture
+  # "005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi", which
+  # has one of each. Specs use these to build larger transmissions
+  #
+  # @return [Array(String, String, String)]
+  def envelopes
+    @envelopes ||= begin
+      input = read("005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi")
+      [input[/^ISA.*?~/], input[/^GS.*?~/], input[/^ST.*?^SE.*?~/m]].map(&:freeze).freeze
+    end
+  end
+
+  # The interchange of the HP835 fixture used by {#envelopes}
+  #
+  # @return [String]
+  def interchange
+    read("005010/X221 HP835 Health Care Claim Payment Advice/case/2.edi")[/^ISA.*?^IEA.*?~/m]
+  end
+
+  # The transaction set from {#envelopes} with the control number `n`
+  #
+  # @return [String]
+  def transaction_set(n)
+    envelopes.last.gsub("112233", n)
+  end
+
+  # One interchange with one functional group that contains `sets`, using
+  # the ISA and GS segments from {#envelopes}
+  #
+  # @return [String]
+  def transmission(*sets)
+    isa, gs, = envelopes
+    [isa, gs, *sets, "GE*#{sets.length}*1~", "IEA*1*000000905~"].join("\n")
+  end
+
   # @return [Stupidedi::Parser::StateMachine, Stupidedi::Reader::Result]
   def parse(path, config = nil)
     if path.is_a?(String)
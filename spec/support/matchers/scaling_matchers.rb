@@ -0,0 +1,40 @@
+using Stupidedi::Refinements
+
+# Checks that the cost per unit of size, of the largest sample from
+# {Quickcheck::Scaling#measure}, is within `tolerance` times the cost per
+# unit of the smallest sample. The cost per unit stays the same, or falls
+# as fixed costs are spread out, when the work grows linearly. When the
+# work grows quadratically, the cost per unit grows with the size, and
+# the samples span a wide enough range that this is larger than the noise
+# in measuring time.
+#
+# Allocations are counted exactly, so they can be checked with a tighter
+# tolerance than time.
+#
+# @example
+#   expect(samples).to grow_linearly(:allocations)
+#   expect(samples).to grow_linearly(:seconds, 2.0)
+#
+RSpec::Matchers.define :grow_linearly do |attribute, tolerance = 1.1|
+  def per_unit(sample, attribute)
+    sample.send(attribute).to_f / sample.size
+  end
+
+  def ratio(samples, attribute)
+    per_unit(samples.last, attribute) / [per_unit(samples.head, attribute), Float::EPSILON].max
+  end
+
+  match do |samples|
+    ratio(samples, attribute) <= tolerance
+  end
+
+  failure_message do |samples|
+    rows = samples.map do |s|
+      "  size %8d: %14s  (%s per unit)" % [s.size, s.send(attribute).round(6),
+        per_unit(s, attribute).round(6)]
+    end
+
+    "expected #{attribute} to grow linearly, but the cost per unit grew " \
+      "%.2fx, more than #{tolerance}x:\n#{rows.join("\n")}" % ratio(samples, attribute)
+  end
+end
@@ -0,0 +1,273 @@
+require "support/quickcheck"
+using Stupidedi::Refinements
+
+class Quickcheck
+  #
+  # Generates X12 transmissions with random content, whose size is chosen
+  # by a few shape parameters (the number of claims, service lines, etc),
+  # and measures how the time and allocations of some work grow as one of
+  # those parameters grows. Used with the `grow_linearly` matcher, this
+  # catches work that grows quadratically, which isn't noticeable with the
+  # inputs in spec/fixtures.
+  #
+  # @example
+  #   Quickcheck::Scaling.property(self, "parses claims in linear time") do
+  #     lines = between(1, 3)
+  #
+  #     measure([25, 50, 100], lambda{|n| hc837(:claims => n, :lines => lines) }) do |input|
+  #       parser.read(Stupidedi::Reader.build(input))
+  #     end
+  #   end.check(3) do |samples|
+  #     expect(samples).to grow_linearly(:allocations)
+  #   end
+  #
+  class Scaling < ::Quickcheck
+    Sample = Struct.new(:size, :seconds, :allocations)
+
+    has_parameter :separators, Stupidedi::Reader::Separators.build(
+      :segment => "~\n", :element => "*", :component => ":", :repetition => "^")
+
+    # The number of times the work is repeated for each size. The smallest
+    # time is reported, because it has the least interference from the
+    # rest of the system
+    has_parameter :samples, 3
+
+    # Generates a transmission with one 837P transaction set that has
+    # `:providers` billing provider (2000A) loops, each with `:subscribers`
+    # subscriber (2000B) loops. When `:patients` is greater than zero, each
+    # subscriber has that many patient (2000C) loops. Each subscriber or
+    # patient has `:claims` claim (2300) loops with `:lines` service line
+    # (2400) loops.
+    #
+    # The 2300 and 2400 loops have a maximum repeat count, but the parser
+    # reads any number of them; only the editor checks the count.
+    #
+    # @return [String]
+    def hc837(options = {})
+      providers   = options.fetch(:providers, 1)
+      subscribers = options.fetch(:subscribers, 1)
+      patients    = options.fetch(:patients, 0)
+      claims      = options.fetch(:claims, 1)
+      lines       = options.fetch(:lines, 1)
+
+      body = []
+      body << ["BHT", "0019", "00", digits(6), date, "1023", "CH"]
+      body << ["NM1", "41", "2", name, "", "", "", "", "46", alnum(5)]
+      body << ["PER", "IC", name, "TE", digits(10)]
+      body << ["NM1", "40", "2", name, "", "", "", "", "46", alnum(8)]
+
+      hl = 0
+
+      providers.times do
+        provider = hl += 1
+        body << ["HL", provider, "", "20", "1"]
+        body << ["NM1", "85", "2", name, "", "", "", "", "XX", digits(10)]
+        body << ["N3", address]
+        body << ["N4", name, "FL", digits(5)]
+        body << ["REF", "EI", digits(9)]
+
+        subscribers.times do
+          subscriber = hl += 1
+          body << ["HL", subscriber, provider, "22", patients.zero? ? "0" : "1"]
+          body << ["SBR", patients.zero? ? "P" : "S", patients.zero? ? "18" : "", "", "", "", "", "", "", "CI"]
+          body << ["NM1", "IL", "1", name, name, "", "", "", "MI", alnum(10)]
+          body << ["NM1", "PR", "2", name, "", "", "", "", "PI", digits(9)]
+
+          if patients.zero?
+            hc837_claims(body, claims, lines)
+          else
+            patients.times do
+              body << ["HL", hl += 1, subscriber, "23", "0"]
+              body << ["PAT", "19"]
+              body << ["NM1", "QC", "1", name, name]
+              body << ["N3", address]
+              body << ["N4", name, "FL", digits(5)]
+              body << ["DMG", "D8", date, choose(%w(F M U))]
+              hc837_claims(body, claims, lines)
+            end
+          end
+        end
+      end
+
+      transmission("HC", "005010X222A1", ["ST", "837", "0001", "005010X222A1"], body)
+    end
+
+    # Generates a transmission with one 835 transaction set that has
+    # `:claims` claim payment (2100) loops, each with `:services` service
+    # payment (2110) loops
+    #
+    # @return [String]
+    def hp835(options = {})
+      claims   = options.fetch(:claims, 1)
+      services = options.fetch(:services, 1)
+
+      body = []
+      body << ["BPR", "I", amount, "C", "CHK", "", "", "", "", "", "", "", "", "", "", "", date]
+      body << ["TRN", "1", digits(5), "1#{digits(9)}"]
+      body << ["N1", "PR", name]
+      body << ["N3", address]
+      body << ["N4", name, "PA", digits(5)]
+      body << ["PER", "BL", name, "TE", digits(10)]
+      body << ["N1", "PE", name, "FI", digits(9)]
+
+      claims.times do |n|
+        body << ["LX", n + 1]
+        body << ["CLP", alnum(7), "1", amount, amount, "", "12", digits(15)]
+        body << ["NM1", "QC", "1", name, name, "", "", "", "MI", alnum(8)]
+
+        services.times do
+          body << ["SVC", ["AD", "D#{digits(4)}"], amount, amount]
+          body << ["DTM", "472", date]
+          body << ["CAS", "CO", "131", amount]
+          body << ["AMT", "B6", amount]
+        end
+      end
+
+      transmission("HP", "005010X221A1", ["ST", "835", "0001"], body)
+    end
+
+    # Generates a transmission with one 834 transaction set that has
+    # `:members` member (2000) loops, each with `:coverages` health
+    # coverage (2300) loops. The DMG05 element of each member has `:races`
+    # repetitions, which is allowed to exceed its maximum of 10
+    #
+    # @return [String]
+    def be834(options = {})
+      members   = options.fetch(:members, 1)
+      coverages = options.fetch(:coverages, 1)
+      races     = options.fetch(:races, 1)
+
+      body = []
+      body << ["BGN", "00", digits(5), date, "1200", "", "", "", "2"]
+      body << ["N1", "P5", "", "FI", digits(9)]
+      body << ["N1", "IN", "", "FI", digits(9)]
+
+      members.times do
+        body << ["INS", "Y", "18", "021", "20", "A", "", "", "FT"]
+        body << ["REF", "0F", digits(9)]
+        body << ["NM1", "IL", "1", name, name, "", "", "", "34", digits(9)]
+        body << ["N3", address]
+        body << ["N4", name, "PA", digits(5)]
+        body << ["DMG", "D8", date, choose(%w(F M U)), "",
+          Array.new(races){ [choose(%w(7 8 A B C D E F G H I J N O P Z))] }]
+
+        coverages.times do
+          body << ["HD", "021", "", choose(%w(HLT DEN VIS))]
+          body << ["DTP", "348", "D8", date]
+        end
+      end
+
+      transmission("BE", "005010X220A1", ["ST", "834", "0001", "005010X220A1"], body)
+    end
+
+    # Calls `setup` with each of `sizes`, and measures the time and number
+    # of allocated objects when the block is called with the result
+    #
+    # @return [Array<Sample>]
+    def measure(sizes, setup)
+      sizes.map do |size|
+        input       = setup.call(size)
+        seconds     = []
+        allocations = []
+
+        samples.times do
+          # The garbage collector is disabled while measuring, because the
+          # time it takes depends on the objects left by the previous work
+          GC.start
+          GC.disable
+
+          begin
+            count = GC.stat(:total_allocated_objects)
+            start = Process.clock_gettime(Process::CLOCK_PROCESS_CPUTIME_ID)
+
+            yield input
+
+            seconds     << Process.clock_gettime(Process::CLOCK_PROCESS_CPUTIME_ID) - start
+            allocations << GC.stat(:total_allocated_objects) - count
+          ensure
+            GC.enable
+          end
+        end
+
+        Sample.new(size, seconds.min, allocations.min)
+      end
+    end
+
+  private
+
+    def hc837_claims(body, claims, lines)
+      claims.times do
+        body << ["CLM", alnum(10), amount, "", "", ["11", "B", "1"], "Y", "A", "Y", "I"]
+        body << ["HI", ["BK", digits(4)], ["BF", "V#{digits(4)}"]]
+
+        lines.times do |n|
+          body << ["LX", n + 1]
+          body << ["SV1", ["HC", digits(5)], amount, "UN", "1", "", "", "1"]
+          body << ["DTP", "472", "D8", date]
+        end
+      end
+    end
+
+    # Wraps the segments of one transaction set in an interchange and a
+    # functional group
+    #
+    # @return [String]
+    def transmission(functional_id, version, st, body)
+      sender, receiver = alnum(15), alnum(15)
+
+      segments = []
+      segments << ["ISA", "00", " " * 10, "00", " " * 10, "ZZ", sender, "ZZ", receiver,
+        "061015", "1705", separators.repetition, "00501", "000000001", "0", "T", separators.component]
+      segments << ["GS", functional_id, sender, receiver, date, "1705", "1", "X", version]
+      segments << st
+      segments.concat(body)
+      segments << ["SE", body.length + 2, "0001"]
+      segments << ["GE", "1", "1"]
+      segments << ["IEA", "1", "000000001"]
+
+      segments.map{|s| segment(*s) }.join
+    end
+
+    # Each element is a `String`, or an `Array` of components, or an `Array`
+    # of `Arrays` of components when it's repeated
+    #
+    # @return [String]
+    def segment(id, *elements)
+      elements = elements.map do |e|
+        if e.is_a?(Array) and e.first.is_a?(Array)
+          e.map{|r| r.join(separators.component) }.join(separators.repetition)
+        elsif e.is_a?(Array)
+          e.join(separators.component)
+        else
+          e.to_s
+        end
+      end
+
+      [id, *elements].join(separators.element) + separators.segment
+    end
+
+    def name
+      with(:size, between(3, 12)) { string(:upper) }
+    end
+
+    def address
+      "#{between(1, 9999)} #{name} ST"
+    end
+
+    def digits(size)
+      with(:size, size) { string(:digit) }
+    end
+
+    def alnum(size)
+      with(:size, size) { string(/[A-Z0-9]/) }
+    end
+
+    def amount
+      "#{between(1, 9999)}.#{digits(2)}"
+    end
+
+    def date
+      "20#{between(10, 19)}#{"%02d" % between(1, 12)}#{"%02d" % between(1, 28)}"
+    end
+  end
+end